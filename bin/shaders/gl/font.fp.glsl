@@ -15,5 +15,6 @@ void main()
 		//discard;
 	}
 
-	ocolor = vec4(color.xyz, color.w * texture(tex, coord).x);
+	//glyph coords are in atlas pixels, pages grow without invalidating them
+	ocolor = vec4(color.xyz, color.w * texture(tex, coord / vec2(textureSize(tex, 0))).x);
 }
\ No newline at end of file
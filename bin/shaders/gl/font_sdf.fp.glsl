@@ -0,0 +1,18 @@
+#version 420
+
+in vec2 coord;
+in vec4 pos;
+uniform vec4 color;
+out vec4 ocolor;
+uniform vec4 clip;
+
+uniform sampler2D tex;
+
+void main()
+{
+	//distance field, 0.5 is the glyph outline. the edge is kept one screen pixel wide at any scale
+	float distance = texture(tex, coord / vec2(textureSize(tex, 0))).x;
+	float width = max(fwidth(distance), 0.0001);
+
+	ocolor = vec4(color.xyz, color.w * smoothstep(0.5 - width, 0.5 + width, distance));
+}
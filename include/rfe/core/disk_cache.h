@@ -0,0 +1,41 @@
+#pragma once
+#include <rfe/core/types.h>
+#include <rfe/core/mapped_file.h>
+#include <initializer_list>
+#include <string>
+
+namespace rfe
+{
+	inline namespace core
+	{
+		//files kept between runs, named by a key of content hashes. entries are mapped on load
+		class disk_cache
+		{
+			std::string m_directory;
+
+		public:
+			static constexpr u64 hash_seed = 14695981039346656037ULL;
+
+			//creates the directory when it is missing
+			disk_cache(const std::string &directory);
+
+			const std::string& directory() const
+			{
+				return m_directory;
+			}
+
+			bool load(const std::string &key, mapped_file &result) const;
+			//goes to a temporary file first, readers never see a partial entry
+			bool store(const std::string &key, const void *data, std::size_t size) const;
+			void remove(const std::string &key) const;
+
+			//fnv-1a, chained through the seed
+			static u64 hash(const void *data, std::size_t size, u64 seed = hash_seed);
+			static u64 hash(const std::string &text, u64 seed = hash_seed);
+			static u64 file_hash(const std::string &path);
+
+			//kind followed by the parts in hex, usable as a file name
+			static std::string key(const std::string &kind, std::initializer_list<u64> parts);
+		};
+	}
+}
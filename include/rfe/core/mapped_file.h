@@ -0,0 +1,45 @@
+#pragma once
+#include <rfe/core/types.h>
+#include <string>
+
+namespace rfe
+{
+	inline namespace core
+	{
+		//read only view of a whole file, mapped into memory instead of copied
+		class mapped_file
+		{
+			void *m_file = nullptr;
+			void *m_mapping = nullptr;
+			const u8 *m_data = nullptr;
+			std::size_t m_size = 0;
+
+		public:
+			mapped_file() = default;
+			mapped_file(const mapped_file&) = delete;
+			mapped_file(mapped_file &&rhs);
+			~mapped_file();
+
+			mapped_file& operator =(const mapped_file&) = delete;
+			mapped_file& operator =(mapped_file &&rhs);
+
+			bool open(const std::string &path);
+			void close();
+
+			bool is_open() const
+			{
+				return m_data != nullptr || m_file != nullptr;
+			}
+
+			const u8 *data() const
+			{
+				return m_data;
+			}
+
+			std::size_t size() const
+			{
+				return m_size;
+			}
+		};
+	}
+}
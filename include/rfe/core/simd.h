@@ -0,0 +1,84 @@
+#pragma once
+
+#if !defined(RFE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RFE_SIMD_SSE 1
+#include <emmintrin.h>
+#elif !defined(RFE_NO_SIMD) && (defined(__aarch64__) || defined(_M_ARM64))
+#define RFE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rfe
+{
+	inline namespace core
+	{
+		//four floats in a register. sse2 and neon are part of every x64 and arm64 target, so the set is picked
+		//at compile time. RFE_NO_SIMD or any other target gets a plain array with the same functions
+		namespace simd
+		{
+#if defined(RFE_SIMD_SSE)
+			static constexpr bool enabled = true;
+			using f32x4 = __m128;
+
+			inline f32x4 load(const float *data) { return _mm_loadu_ps(data); }
+			inline void store(float *data, f32x4 value) { _mm_storeu_ps(data, value); }
+			inline f32x4 splat(float value) { return _mm_set1_ps(value); }
+			inline f32x4 set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+			//two floats repeated, x y x y
+			inline f32x4 load_pair(const float *data) { return _mm_castpd_ps(_mm_load1_pd((const double*)data)); }
+			inline f32x4 add(f32x4 lhs, f32x4 rhs) { return _mm_add_ps(lhs, rhs); }
+			inline f32x4 sub(f32x4 lhs, f32x4 rhs) { return _mm_sub_ps(lhs, rhs); }
+			inline f32x4 mul(f32x4 lhs, f32x4 rhs) { return _mm_mul_ps(lhs, rhs); }
+			inline f32x4 div(f32x4 lhs, f32x4 rhs) { return _mm_div_ps(lhs, rhs); }
+
+			//the lane in all four
+			template<int Lane>
+			inline f32x4 lane(f32x4 value) { return _mm_shuffle_ps(value, value, _MM_SHUFFLE(Lane, Lane, Lane, Lane)); }
+			//lhs x y, rhs x y
+			inline f32x4 low_halves(f32x4 lhs, f32x4 rhs) { return _mm_movelh_ps(lhs, rhs); }
+			//lhs z w, rhs z w
+			inline f32x4 high_halves(f32x4 lhs, f32x4 rhs) { return _mm_movehl_ps(rhs, lhs); }
+#elif defined(RFE_SIMD_NEON)
+			static constexpr bool enabled = true;
+			using f32x4 = float32x4_t;
+
+			inline f32x4 load(const float *data) { return vld1q_f32(data); }
+			inline void store(float *data, f32x4 value) { vst1q_f32(data, value); }
+			inline f32x4 splat(float value) { return vdupq_n_f32(value); }
+			inline f32x4 set(float x, float y, float z, float w) { const float data[4] = { x, y, z, w }; return vld1q_f32(data); }
+			inline f32x4 load_pair(const float *data) { float32x2_t pair = vld1_f32(data); return vcombine_f32(pair, pair); }
+			inline f32x4 add(f32x4 lhs, f32x4 rhs) { return vaddq_f32(lhs, rhs); }
+			inline f32x4 sub(f32x4 lhs, f32x4 rhs) { return vsubq_f32(lhs, rhs); }
+			inline f32x4 mul(f32x4 lhs, f32x4 rhs) { return vmulq_f32(lhs, rhs); }
+			inline f32x4 div(f32x4 lhs, f32x4 rhs) { return vdivq_f32(lhs, rhs); }
+
+			template<int Lane>
+			inline f32x4 lane(f32x4 value) { return vdupq_laneq_f32(value, Lane); }
+			inline f32x4 low_halves(f32x4 lhs, f32x4 rhs) { return vcombine_f32(vget_low_f32(lhs), vget_low_f32(rhs)); }
+			inline f32x4 high_halves(f32x4 lhs, f32x4 rhs) { return vcombine_f32(vget_high_f32(lhs), vget_high_f32(rhs)); }
+#else
+			static constexpr bool enabled = false;
+
+			struct f32x4
+			{
+				float v[4];
+			};
+
+			inline f32x4 load(const float *data) { return{ { data[0], data[1], data[2], data[3] } }; }
+			inline void store(float *data, f32x4 value) { for (int i = 0; i < 4; ++i) data[i] = value.v[i]; }
+			inline f32x4 splat(float value) { return{ { value, value, value, value } }; }
+			inline f32x4 set(float x, float y, float z, float w) { return{ { x, y, z, w } }; }
+			inline f32x4 load_pair(const float *data) { return{ { data[0], data[1], data[0], data[1] } }; }
+			inline f32x4 add(f32x4 lhs, f32x4 rhs) { for (int i = 0; i < 4; ++i) lhs.v[i] += rhs.v[i]; return lhs; }
+			inline f32x4 sub(f32x4 lhs, f32x4 rhs) { for (int i = 0; i < 4; ++i) lhs.v[i] -= rhs.v[i]; return lhs; }
+			inline f32x4 mul(f32x4 lhs, f32x4 rhs) { for (int i = 0; i < 4; ++i) lhs.v[i] *= rhs.v[i]; return lhs; }
+			inline f32x4 div(f32x4 lhs, f32x4 rhs) { for (int i = 0; i < 4; ++i) lhs.v[i] /= rhs.v[i]; return lhs; }
+
+			template<int Lane>
+			inline f32x4 lane(f32x4 value) { return splat(value.v[Lane]); }
+			inline f32x4 low_halves(f32x4 lhs, f32x4 rhs) { return{ { lhs.v[0], lhs.v[1], rhs.v[0], rhs.v[1] } }; }
+			inline f32x4 high_halves(f32x4 lhs, f32x4 rhs) { return{ { lhs.v[2], lhs.v[3], rhs.v[2], rhs.v[3] } }; }
+#endif
+		}
+	}
+}
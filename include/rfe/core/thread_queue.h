@@ -3,6 +3,8 @@
 #include <thread>
 #include <future>
 #include <unordered_set>
+#include <condition_variable>
+#include <vector>
 
 namespace rfe
 {
@@ -337,6 +339,89 @@ namespace rfe
 			}
 		};
 
+		class thread_pool_context : public thread_queue_context_base
+		{
+			std::deque<std::function<void()>> m_queue;
+			std::vector<std::thread> m_threads;
+			mutable std::mutex m_mtx;
+			std::condition_variable m_cv;
+			std::size_t m_in_progress = 0;
+			bool m_stop = false;
+
+			void work()
+			{
+				while (true)
+				{
+					std::function<void()> function;
+
+					{
+						std::unique_lock<std::mutex> lock{ m_mtx };
+						m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+
+						if (m_queue.empty())
+						{
+							return;
+						}
+
+						function = std::move(m_queue.front());
+						m_queue.pop_front();
+					}
+
+					function();
+
+					std::lock_guard<std::mutex> lock{ m_mtx };
+					--m_in_progress;
+				}
+			}
+
+		public:
+			thread_pool_context(std::size_t threads)
+			{
+				for (std::size_t i = 0; i < threads; ++i)
+				{
+					m_threads.emplace_back([this] { work(); });
+				}
+			}
+
+			~thread_pool_context()
+			{
+				{
+					std::lock_guard<std::mutex> lock{ m_mtx };
+					m_stop = true;
+				}
+
+				m_cv.notify_all();
+
+				for (auto &thread : m_threads)
+				{
+					thread.join();
+				}
+			}
+
+			void push(std::function<void()> function) override
+			{
+				if (m_threads.empty())
+				{
+					function();
+					return;
+				}
+
+				{
+					std::lock_guard<std::mutex> lock{ m_mtx };
+					m_queue.push_back(std::move(function));
+					++m_in_progress;
+				}
+
+				m_cv.notify_one();
+			}
+
+			bool empty() const override
+			{
+				std::lock_guard<std::mutex> lock{ m_mtx };
+				return m_in_progress == 0;
+			}
+		};
+
 		inline thread_queue& thread_queue::main_thread()
 		{
 			static thread_queue result{ std::make_shared<thread_queue_context>(no_thread) };
@@ -348,5 +433,11 @@ namespace rfe
 		{
 			return std::make_shared<multi_thread_queue_context>();
 		}
+
+		//fixed set of workers sharing one queue, pushes run inline when there are no workers
+		inline thread_queue make_thread_pool_queue(std::size_t threads = std::thread::hardware_concurrency())
+		{
+			return std::make_shared<thread_pool_context>(threads);
+		}
 	}
 }
@@ -8,6 +8,7 @@
 #include <cassert>
 #include <type_traits>
 #include <mutex>
+#include "simd.h"
 
 #if defined(_MSC_VER) && !defined(__GNUG__)
 #define EXTCONSTEXPR
@@ -411,6 +412,80 @@ namespace rfe
 			protected:
 				type m_data[dimension];
 
+				//vector4f arithmetic goes through a register
+				static constexpr bool packed = simd::enabled && dimension == 4 && std::is_same<type, float>::value;
+
+				static vector packed_result(simd::f32x4 value)
+				{
+					vector result;
+					simd::store(result.m_data, value);
+					return result;
+				}
+
+				using packed_t = std::integral_constant<bool, packed>;
+
+				//lane operations, the register overload wins for simd::f32x4 arguments
+				struct sub_op
+				{
+					simd::f32x4 operator()(simd::f32x4 lhs, simd::f32x4 rhs) const { return simd::sub(lhs, rhs); }
+					template<typename L, typename R>
+					constexpr auto operator()(const L& lhs, const R& rhs) const -> decltype(lhs - rhs) { return lhs - rhs; }
+				};
+				struct add_op
+				{
+					simd::f32x4 operator()(simd::f32x4 lhs, simd::f32x4 rhs) const { return simd::add(lhs, rhs); }
+					template<typename L, typename R>
+					constexpr auto operator()(const L& lhs, const R& rhs) const -> decltype(lhs + rhs) { return lhs + rhs; }
+				};
+				struct mul_op
+				{
+					simd::f32x4 operator()(simd::f32x4 lhs, simd::f32x4 rhs) const { return simd::mul(lhs, rhs); }
+					template<typename L, typename R>
+					constexpr auto operator()(const L& lhs, const R& rhs) const -> decltype(lhs * rhs) { return lhs * rhs; }
+				};
+				struct div_op
+				{
+					simd::f32x4 operator()(simd::f32x4 lhs, simd::f32x4 rhs) const { return simd::div(lhs, rhs); }
+					template<typename L, typename R>
+					constexpr auto operator()(const L& lhs, const R& rhs) const -> decltype(lhs / rhs) { return lhs / rhs; }
+				};
+
+				//picked by packed_t, so the register versions are only instantiated for vector4f
+				template<typename Op>
+				vector apply(const vector& rhs, Op op, std::true_type) const
+				{
+					return packed_result(op(simd::load(m_data), simd::load(rhs.m_data)));
+				}
+				template<typename Op>
+				EXTCONSTEXPR vector apply(const vector& rhs, Op op, std::false_type) const
+				{
+					vector result;
+
+					for (int i = 0; i < dimension; ++i)
+					{
+						result.m_data[i] = op(m_data[i], rhs.m_data[i]);
+					}
+
+					return result;
+				}
+				template<typename Op>
+				vector apply_scalar(Type rhs, Op op, std::true_type) const
+				{
+					return packed_result(op(simd::load(m_data), simd::splat(rhs)));
+				}
+				template<typename Op>
+				EXTCONSTEXPR vector apply_scalar(Type rhs, Op op, std::false_type) const
+				{
+					vector result;
+
+					for (int i = 0; i < dimension; ++i)
+					{
+						result.m_data[i] = op(m_data[i], rhs);
+					}
+
+					return result;
+				}
+
 			public:
 				using iterator = type *;
 				using const_iterator = const type *;
@@ -541,92 +616,36 @@ namespace rfe
 
 				EXTCONSTEXPR vector operator -(const vector& rhs) const
 				{
-					vector result;
-
-					for (int i = 0; i < dimension; ++i)
-					{
-						result.m_data[i] = m_data[i] - rhs.m_data[i];
-					}
-
-					return result;
+					return apply(rhs, sub_op{}, packed_t{});
 				}
 				EXTCONSTEXPR vector operator -(Type rhs) const
 				{
-					vector result;
-
-					for (int i = 0; i < dimension; ++i)
-					{
-						result.m_data[i] = m_data[i] - rhs;
-					}
-
-					return result;
+					return apply_scalar(rhs, sub_op{}, packed_t{});
 				}
 				EXTCONSTEXPR vector operator +(const vector& rhs) const
 				{
-					vector result;
-
-					for (int i = 0; i < dimension; ++i)
-					{
-						result.m_data[i] = m_data[i] + rhs.m_data[i];
-					}
-
-					return result;
+					return apply(rhs, add_op{}, packed_t{});
 				}
 				EXTCONSTEXPR vector operator +(Type rhs) const
 				{
-					vector result;
-
-					for (int i = 0; i < dimension; ++i)
-					{
-						result.m_data[i] = m_data[i] + rhs;
-					}
-
-					return result;
+					return apply_scalar(rhs, add_op{}, packed_t{});
 				}
 
 				EXTCONSTEXPR vector operator *(Type rhs) const
 				{
-					vector result;
-
-					for (int i = 0; i < dimension; ++i)
-					{
-						result.m_data[i] = m_data[i] * rhs;
-					}
-
-					return result;
+					return apply_scalar(rhs, mul_op{}, packed_t{});
 				}
 				EXTCONSTEXPR vector operator *(const vector& rhs) const
 				{
-					vector result;
-
-					for (int i = 0; i < dimension; ++i)
-					{
-						result.m_data[i] = m_data[i] * rhs.m_data[i];
-					}
-
-					return result;
+					return apply(rhs, mul_op{}, packed_t{});
 				}
 				EXTCONSTEXPR vector operator /(Type rhs) const
 				{
-					vector result;
-
-					for (int i = 0; i < dimension; ++i)
-					{
-						result.m_data[i] = m_data[i] / rhs;
-					}
-
-					return result;
+					return apply_scalar(rhs, div_op{}, packed_t{});
 				}
 				EXTCONSTEXPR vector operator /(const vector& rhs) const
 				{
-					vector result;
-
-					for (int i = 0; i < dimension; ++i)
-					{
-						result.m_data[i] = m_data[i] / rhs.m_data[i];
-					}
-
-					return result;
+					return apply(rhs, div_op{}, packed_t{});
 				}
 
 				vector& operator -=(const vector& rhs)
@@ -1051,25 +1070,243 @@ namespace rfe
 				}
 			};
 
+			//plain loops for every size and type. the operators use them for everything but matrix4f,
+			//benchmarks compare them with the simd versions
+			namespace generic
+			{
+				template<typename Type, int LRowCount, int LColumnCount, int RRowCount, int RColumnCount>
+				matrix<Type, LRowCount, RColumnCount> multiply(const matrix<Type, LRowCount, LColumnCount> &lhs, const matrix<Type, RRowCount, RColumnCount> &rhs)
+				{
+					static_assert(LColumnCount == RRowCount, "Incompatible matrices");
+
+					matrix<Type, LRowCount, RColumnCount> result;
+
+					for (int i = 0; i < LRowCount; ++i)
+					{
+						for (int j = 0; j < RColumnCount; ++j)
+						{
+							for (int k = 0; k < LColumnCount; ++k)
+							{
+								result[i][j] += lhs[i][k] * rhs[k][j];
+							}
+						}
+					}
+
+					return result;
+				}
+
+				//the row vector times the matrix, offsets are in the last row
+				template<typename Type, int RowCount, int ColumnCount>
+				vector<ColumnCount, Type> transform(const vector<RowCount, Type> &lhs, const matrix<Type, RowCount, ColumnCount> &rhs)
+				{
+					vector<ColumnCount, Type> result;
+
+					for (int j = 0; j < ColumnCount; ++j)
+					{
+						for (int k = 0; k < RowCount; ++k)
+						{
+							result[j] += lhs[k] * rhs[k][j];
+						}
+					}
+
+					return result;
+				}
+
+				//gauss-jordan with partial pivoting, singular matrices give the zero matrix
+				template<typename Type, int Count>
+				matrix<Type, Count, Count> inverse(const matrix<Type, Count, Count> &source)
+				{
+					matrix<Type, Count, Count> rows = source;
+					matrix<Type, Count, Count> result(Type(1));
+
+					for (int k = 0; k < Count; ++k)
+					{
+						int pivot = k;
+
+						for (int i = k + 1; i < Count; ++i)
+						{
+							if (std::abs(rows[i][k]) > std::abs(rows[pivot][k]))
+							{
+								pivot = i;
+							}
+						}
+
+						if (rows[pivot][k] == Type(0))
+						{
+							return{};
+						}
+
+						std::swap(rows[k], rows[pivot]);
+						std::swap(result[k], result[pivot]);
+
+						Type scale = Type(1) / rows[k][k];
+
+						for (int j = 0; j < Count; ++j)
+						{
+							rows[k][j] = rows[k][j] * scale;
+							result[k][j] = result[k][j] * scale;
+						}
+
+						for (int i = 0; i < Count; ++i)
+						{
+							if (i == k)
+							{
+								continue;
+							}
+
+							Type factor = rows[i][k];
+
+							for (int j = 0; j < Count; ++j)
+							{
+								rows[i][j] = rows[i][j] - rows[k][j] * factor;
+								result[i][j] = result[i][j] - result[k][j] * factor;
+							}
+						}
+					}
+
+					return result;
+				}
+
+				inline matrix<float, 4, 4> scale_offset(const vector<3, float> &scale, const vector<3, float> &offset)
+				{
+					return
+					{ {
+						{ scale[0], 0.f, 0.f, 0.f },
+						{ 0.f, scale[1], 0.f, 0.f },
+						{ 0.f, 0.f, scale[2], 0.f },
+						{ offset[0], offset[1], offset[2], 1.f },
+					} };
+				}
+			}
+
 			template<typename Type, int LRowCount, int LColumnCount, int RRowCount, int RColumnCount>
 			matrix<Type, LRowCount, RColumnCount> operator *(const matrix<Type, LRowCount, LColumnCount> &lhs, const matrix<Type, RRowCount, RColumnCount> &rhs)
 			{
-				static_assert(LColumnCount == RRowCount, "Incompatible matrices");
+				return generic::multiply(lhs, rhs);
+			}
+
+			template<typename Type, int RowCount, int ColumnCount>
+			vector<ColumnCount, Type> operator *(const vector<RowCount, Type> &lhs, const matrix<Type, RowCount, ColumnCount> &rhs)
+			{
+				return generic::transform(lhs, rhs);
+			}
+
+			template<typename Type, int Count>
+			matrix<Type, Count, Count> inverse(const matrix<Type, Count, Count> &source)
+			{
+				return generic::inverse(source);
+			}
+
+			//matrix4f overloads win over the templates, a row is a register. same operations in the same order
+			//as the generic versions, so both give the same results
+			inline matrix<float, 4, 4> operator *(const matrix<float, 4, 4> &lhs, const matrix<float, 4, 4> &rhs)
+			{
+#if defined(RFE_SIMD_SSE) || defined(RFE_SIMD_NEON)
+				simd::f32x4 rhs_rows[4] = { simd::load(&rhs[0][0]), simd::load(&rhs[1][0]), simd::load(&rhs[2][0]), simd::load(&rhs[3][0]) };
+				matrix<float, 4, 4> result;
 
-				matrix<Type, LRowCount, RColumnCount> result;
+				for (int i = 0; i < 4; ++i)
+				{
+					simd::f32x4 row = simd::load(&lhs[i][0]);
+					simd::f32x4 value = simd::mul(simd::lane<0>(row), rhs_rows[0]);
+					value = simd::add(value, simd::mul(simd::lane<1>(row), rhs_rows[1]));
+					value = simd::add(value, simd::mul(simd::lane<2>(row), rhs_rows[2]));
+					value = simd::add(value, simd::mul(simd::lane<3>(row), rhs_rows[3]));
+					simd::store(&result[i][0], value);
+				}
 
-				for (int i = 0; i < LRowCount; ++i)
+				return result;
+#else
+				return generic::multiply(lhs, rhs);
+#endif
+			}
+
+			inline vector<4, float> operator *(const vector<4, float> &lhs, const matrix<float, 4, 4> &rhs)
+			{
+#if defined(RFE_SIMD_SSE) || defined(RFE_SIMD_NEON)
+				simd::f32x4 row = simd::load(&lhs[0]);
+				simd::f32x4 value = simd::mul(simd::lane<0>(row), simd::load(&rhs[0][0]));
+				value = simd::add(value, simd::mul(simd::lane<1>(row), simd::load(&rhs[1][0])));
+				value = simd::add(value, simd::mul(simd::lane<2>(row), simd::load(&rhs[2][0])));
+				value = simd::add(value, simd::mul(simd::lane<3>(row), simd::load(&rhs[3][0])));
+
+				vector<4, float> result;
+				simd::store(&result[0], value);
+				return result;
+#else
+				return generic::transform(lhs, rhs);
+#endif
+			}
+
+			inline matrix<float, 4, 4> inverse(const matrix<float, 4, 4> &source)
+			{
+#if defined(RFE_SIMD_SSE) || defined(RFE_SIMD_NEON)
+				//the pivots are picked from memory, the rows are updated in registers
+				float rows[4][4];
+				float result[4][4];
+
+				for (int i = 0; i < 4; ++i)
+				{
+					simd::store(rows[i], simd::load(&source[i][0]));
+					simd::store(result[i], simd::set(i == 0 ? 1.f : 0.f, i == 1 ? 1.f : 0.f, i == 2 ? 1.f : 0.f, i == 3 ? 1.f : 0.f));
+				}
+
+				for (int k = 0; k < 4; ++k)
 				{
-					for (int j = 0; j < RColumnCount; ++j)
+					int pivot = k;
+
+					for (int i = k + 1; i < 4; ++i)
+					{
+						if (std::abs(rows[i][k]) > std::abs(rows[pivot][k]))
+						{
+							pivot = i;
+						}
+					}
+
+					float pivot_value = rows[pivot][k];
+
+					if (pivot_value == 0.f)
 					{
-						for (int k = 0; k < LColumnCount; ++k)
+						return{};
+					}
+
+					simd::f32x4 scale = simd::splat(1.f / pivot_value);
+					simd::f32x4 row = simd::mul(simd::load(rows[pivot]), scale);
+					simd::f32x4 result_row = simd::mul(simd::load(result[pivot]), scale);
+
+					if (pivot != k)
+					{
+						simd::store(rows[pivot], simd::load(rows[k]));
+						simd::store(result[pivot], simd::load(result[k]));
+					}
+
+					simd::store(rows[k], row);
+					simd::store(result[k], result_row);
+
+					for (int i = 0; i < 4; ++i)
+					{
+						if (i == k)
 						{
-							result[i][j] += lhs[i][k] * rhs[k][j];
+							continue;
 						}
+
+						simd::f32x4 factor = simd::splat(rows[i][k]);
+						simd::store(rows[i], simd::sub(simd::load(rows[i]), simd::mul(row, factor)));
+						simd::store(result[i], simd::sub(simd::load(result[i]), simd::mul(result_row, factor)));
 					}
 				}
 
-				return result;
+				matrix<float, 4, 4> inverse;
+
+				for (int i = 0; i < 4; ++i)
+				{
+					simd::store(&inverse[i][0], simd::load(result[i]));
+				}
+
+				return inverse;
+#else
+				return generic::inverse(source);
+#endif
 			}
 
 			template<int Dimension, typename Type>
@@ -1837,15 +2074,45 @@ namespace rfe
 
 	namespace mtx
 	{
+		//rows are stored whole instead of going through the nested initializers
 		static core::matrix4f scale_offset(const core::vector3f &scale, const core::vector3f &offset)
 		{
-			return
-			{ {
-				{ scale[0], 0.f, 0.f, 0.f },
-				{ 0.f, scale[1], 0.f, 0.f },
-				{ 0.f, 0.f, scale[2], 0.f },
-				{ offset[0], offset[1], offset[2], 1.f },
-			} };
+#if defined(RFE_SIMD_SSE) || defined(RFE_SIMD_NEON)
+			core::matrix4f result;
+			core::simd::store(&result[0][0], core::simd::set(scale[0], 0.f, 0.f, 0.f));
+			core::simd::store(&result[1][0], core::simd::set(0.f, scale[1], 0.f, 0.f));
+			core::simd::store(&result[2][0], core::simd::set(0.f, 0.f, scale[2], 0.f));
+			core::simd::store(&result[3][0], core::simd::set(offset[0], offset[1], offset[2], 1.f));
+			return result;
+#else
+			return core::generic::scale_offset(scale, offset);
+#endif
 		}
+
+		//a rect in pixels of a target of global_size, clipped by its parent. position is relative to the parent,
+		//parent_offset is the parent's absolute position
+		struct rect_source
+		{
+			core::point2f position;
+			core::point2f parent_offset;
+			core::size2f size;
+			core::size2f parent_size;
+			core::size2f global_size;
+		};
+
+		//what the scale_offset matrix of a rect reduces to, x * scale + offset in clip space
+		struct transform2f
+		{
+			core::point2f scale;
+			core::point2f offset;
+		};
+
+		//the clip space matrix of the rect and its clip as top left and bottom right corners, as widgets compute them
+		void rect_transform(const rect_source &source, core::matrix4f &matrix, core::vector4f &clip);
+		void rect_transform(const rect_source &source, transform2f &transform, core::vector4f &clip);
+
+		//the same for count rects, a rect a register. results go to indices[i] when given, to i otherwise
+		void rect_transforms(const rect_source *sources, std::size_t count, core::matrix4f *matrices, core::vector4f *clips, const u32 *indices = nullptr);
+		void rect_transforms(const rect_source *sources, std::size_t count, transform2f *transforms, core::vector4f *clips, const u32 *indices = nullptr);
 	}
 }
@@ -0,0 +1,21 @@
+#pragma once
+#include "image.h"
+
+namespace rfe
+{
+	namespace graphics
+	{
+		//rgba8 or rgb8 image with its levels down to 1x1, or to levels, each a box filtered half of the previous one
+		std::shared_ptr<image> generate_mipmaps(const image &source, int levels = 0);
+
+		//every level of an rgba8 or rgb8 image encoded to bc1, bc3, bc7, etc2_rgb8 or etc2_rgba8.
+		//blocks over the edge repeat the last row and column
+		std::shared_ptr<image> compress(const image &source, pixels_type type);
+		//every level decoded to rgba8, for renderers that cannot sample the format
+		std::shared_ptr<image> decompress(const image &source);
+
+		//rgba of the 16 pixels of a block, row after row
+		void encode_block(pixels_type type, const u8 *rgba, u8 *block);
+		void decode_block(pixels_type type, const u8 *block, u8 *rgba);
+	}
+}
@@ -19,15 +19,26 @@ namespace rfe
 
 		void init();
 
+		//the handle identifies the face, freetype calls go through the face of the calling thread
 		struct face
 		{
 			void *ft_face;
 
+			//FT_Face of the calling thread, opened from the shared file on first use.
+			//pixel sizes and loaded glyphs are per thread
+			void *native() const;
+
 			face& set_pixel_sizes(int pixel_height, int pixel_width = 0);
-			void load_char(char c, load_bits load_bits_ = load_bits::render) const;
-			bool load_char(std::nothrow_t, char c, load_bits load_bits_ = load_bits::render) const noexcept;
+			int pixel_size() const;
+			//empty for faces not loaded by new_face
+			std::string file_path() const;
+			void load_char(u32 codepoint, load_bits load_bits_ = load_bits::render) const;
+			bool load_char(std::nothrow_t, u32 codepoint, load_bits load_bits_ = load_bits::render) const noexcept;
 		};
 
+		//codepoint starting at position, which is moved past it. invalid sequences give U+FFFD
+		u32 decode_utf8(const std::string &text, std::size_t &position);
+
 		struct info
 		{
 			face face;
@@ -63,12 +74,61 @@ namespace rfe
 		};
 
 		using char_coords_t = std::array<point4f, 6>;
-		using text_coords_t = std::vector<char_coords_t>;
+
+		enum class glyph_mode : u8
+		{
+			//coverage rasterized at the drawn size
+			bitmap,
+			//distance field rasterized once at a reference size, drawn at any size
+			sdf
+		};
+
+		struct text_coords_t
+		{
+			std::vector<char_coords_t> chars;
+			//atlas page of every char
+			std::vector<u32> pages;
+			//atlas evictions when prepared, the coords are outdated once it changes
+			u64 evictions = 0;
+		};
+
+		enum class text_align : u8
+		{
+			left,
+			center,
+			right
+		};
+
+		//glyphs of a text positioned in pixels from the top left corner of its box
+		struct text_run_t
+		{
+			struct glyph_t
+			{
+				u32 codepoint;
+				//pen position on the baseline
+				point2f position;
+			};
+
+			std::vector<glyph_t> glyphs;
+			int line_height = 0;
+			std::size_t lines = 0;
+			//widest line, trailing spaces excluded, by the height of all lines
+			size2i size;
+		};
 
 		class drawable_text : public drawable_base
 		{
 		public:
-			virtual text_coords_t prepare(const std::string &text) = 0;
+			//width 0 keeps every line unwrapped, lines are aligned inside the widest one
+			virtual std::shared_ptr<const text_run_t> layout(const std::string &text, int width = 0, text_align align = text_align::left) = 0;
+			virtual text_coords_t prepare(const text_run_t &run) = 0;
+			text_coords_t prepare(const std::string &text)
+			{
+				return prepare(*layout(text));
+			}
+
+			//glyphs the coords refer to were evicted, they have to be prepared again
+			virtual bool outdated(const text_coords_t &coords) const = 0;
 
 			virtual void draw(const text_coords_t &coords, const color4f &color, vector4f clip, const core::matrix<float, 4>& matrix_) = 0;
 			void draw(const std::string &text, const color4f &color, vector4f clip, const core::matrix<float, 4>& matrix_)
@@ -86,8 +146,20 @@ namespace rfe
 
 			u64 m_frames = 0;
 			clock::time_point m_fps_flush_time = clock::now();
+			clock::time_point m_create_time = clock::now();
+			bool m_first_frame = true;
 			bool m_invalidated = true;
-			std::vector<std::weak_ptr<graphics::drawable_base>> m_drawables;
+
+			struct drawable_owner_t
+			{
+				std::weak_ptr<void> parent;
+				std::shared_ptr<drawable_base> drawable;
+			};
+
+			//drawables live until their parent goes or they are replaced
+			std::vector<drawable_owner_t> m_drawables;
+			//destroyed by the next present, on the render thread
+			std::vector<std::shared_ptr<drawable_base>> m_released;
 
 			u32 m_font_texture_id = 0;
 			u32 m_font_vao_id = 0;
@@ -112,6 +184,7 @@ namespace rfe
 				bool m_double_buffer = true;
 				int m_stencil_size = 8;
 				int m_depth_size = 24;
+				std::string m_cache_directory;
 
 			public:
 				settings& double_buffer(bool value)
@@ -129,6 +202,12 @@ namespace rfe
 					m_depth_size = value;
 					return *this;
 				}
+				//linked programs and prewarmed glyphs are kept there between runs, nothing is kept when empty
+				settings& cache_directory(const std::string &value)
+				{
+					m_cache_directory = value;
+					return *this;
+				}
 
 				bool double_buffer() const
 				{
@@ -142,6 +221,10 @@ namespace rfe
 				{
 					return m_depth_size;
 				}
+				const std::string& cache_directory() const
+				{
+					return m_cache_directory;
+				}
 			};
 
 			virtual ~draw_context() = default;
@@ -156,13 +239,34 @@ namespace rfe
 			virtual std::weak_ptr<drawable> prepare(std::shared_ptr<void> parent, const model &m) = 0;
 			virtual std::weak_ptr<drawable_text> prepare(std::shared_ptr<void> parent, const font::face &m) = 0;
 
+			void attach(std::shared_ptr<void> parent, std::shared_ptr<drawable_base> drawable_);
 			void detach(std::weak_ptr<drawable_base> drawable_);
 
 		public:
 			void prepare(std::shared_ptr<void> parent, std::weak_ptr<drawable> &drawable, const model &m);
 			void prepare(std::shared_ptr<void> parent, std::weak_ptr<drawable_text> &drawable, const font::face &m);
 
+			//the drawable and what it holds on the gpu are destroyed by the next present
+			template<typename Type>
+			void release(std::weak_ptr<Type> &drawable_)
+			{
+				std::lock_guard<std::recursive_mutex> lock(m_mtx);
+				detach(drawable_);
+				drawable_.reset();
+			}
+
 			data_event<double> fps;
+			//from the creation of the context to its first present, in milliseconds
+			data_event<double> first_frame_time;
+			//mode of text drawables prepared from now on
+			glyph_mode text_mode = glyph_mode::bitmap;
+
+			//measures the text in the current mode, callable from any thread
+			virtual std::shared_ptr<const text_run_t> layout_text(const font::info &font_, const std::string &text, int width = 0, text_align align = text_align::left) = 0;
+			//rasterizes the characters at every size on worker threads in the current mode, so their first draw does not have to.
+			//printable ascii when empty. ready once the glyphs are uploaded on the render thread
+			virtual std::shared_future<void> prewarm(const font::face &face, const std::vector<int> &sizes, const std::string &characters = {}) = 0;
+
 			void invalidate();
 		};
 
@@ -0,0 +1,179 @@
+#pragma once
+#include <rfe/core/types.h>
+#include "draw_context.h"
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rfe
+{
+	namespace graphics
+	{
+		//bottom left skyline packer, placed rectangles never move
+		class skyline_packer
+		{
+			struct node
+			{
+				int x;
+				int y;
+				int width;
+			};
+
+			size2i m_size;
+			std::vector<node> m_nodes;
+
+			int fit(std::size_t index, size2i size) const;
+
+		public:
+			skyline_packer(size2i size = {});
+
+			void reset(size2i size);
+			//extends the area to the right and bottom, keeping what was packed
+			void grow(size2i size);
+			size2i size() const;
+
+			bool pack(size2i size, point2i &position);
+		};
+
+		//single channel glyph bitmaps of any face, size and codepoint, rasterized on first use.
+		//callable from any thread, freetype runs unlocked on the faces of the calling thread
+		class glyph_atlas
+		{
+		public:
+			static constexpr u32 no_page = ~u32(0);
+
+			//sdf glyphs are rasterized at this size, their metrics are in its pixels
+			static constexpr int sdf_size = 48;
+			//distance covered by the field on each side of the outline
+			static constexpr int sdf_spread = 6;
+
+			struct glyph_t
+			{
+				u32 page = no_page;
+				//pixel area inside the page
+				coord2i atlas_coord;
+				//bearing and bitmap size
+				coord2i coord;
+				point2i advance;
+			};
+
+			struct page_t
+			{
+				size2i size;
+				std::vector<u8> pixels;
+				skyline_packer packer;
+				//changed since the last sync
+				coord2i dirty;
+				u64 last_use = 0;
+			};
+
+			//glyph bitmap rasterized outside of the atlas
+			struct raster_t
+			{
+				coord2i coord;
+				point2i advance;
+				std::vector<u8> pixels;
+			};
+
+			struct line_metrics_t
+			{
+				int ascender;
+				int descender;
+				int height;
+			};
+
+		private:
+			struct key_t
+			{
+				void *face;
+				int size;
+				u32 codepoint;
+				glyph_mode mode;
+
+				bool operator ==(const key_t &rhs) const
+				{
+					return face == rhs.face && size == rhs.size && codepoint == rhs.codepoint && mode == rhs.mode;
+				}
+			};
+
+			struct key_hasher
+			{
+				std::size_t operator()(const key_t &key) const
+				{
+					return std::hash<void*>()(key.face) ^ (std::size_t(key.size) << 21) ^ (std::size_t(key.mode) << 20) ^ std::hash<u32>()(key.codepoint) * 31;
+				}
+			};
+
+			struct kerning_key_t
+			{
+				void *face;
+				int size;
+				u32 left;
+				u32 right;
+
+				bool operator ==(const kerning_key_t &rhs) const
+				{
+					return face == rhs.face && size == rhs.size && left == rhs.left && right == rhs.right;
+				}
+			};
+
+			struct kerning_key_hasher
+			{
+				std::size_t operator()(const kerning_key_t &key) const
+				{
+					return std::hash<void*>()(key.face) ^ (std::size_t(key.size) << 21) ^ std::hash<u64>()((u64(key.left) << 32) | key.right) * 31;
+				}
+			};
+
+			mutable std::mutex m_mtx;
+			std::unordered_map<key_t, glyph_t, key_hasher> m_glyphs;
+			std::unordered_map<kerning_key_t, int, kerning_key_hasher> m_kernings;
+			std::vector<page_t> m_pages;
+
+			std::size_t m_budget;
+			size2i m_initial_page_size;
+			int m_max_page_size;
+			int m_padding = 1;
+
+			u64 m_use = 1;
+			u64 m_evictions = 0;
+
+			std::size_t resident_bytes() const;
+			bool allocate(size2i size, u32 &page, point2i &position);
+			bool grow(page_t &page, bool over_budget);
+			void evict(u32 page);
+			//packs the raster, no bitmap when it is null. lock is held
+			glyph_t insert(const key_t &key, const raster_t *raster);
+
+		public:
+			glyph_atlas(std::size_t budget = 16 << 20, size2i initial_page_size = { 256, 256 }, int max_page_size = 2048);
+
+			//pages used since the last call are kept until the next one
+			void begin_use();
+
+			//false when the glyph has no bitmap, advance is still valid. sdf glyphs ignore the size
+			bool glyph(const font::face &face, int size, u32 codepoint, glyph_t &result, glyph_mode mode = glyph_mode::bitmap);
+
+			//rasterizes the missing glyphs on the calling thread, several threads can warm up one face at once
+			void prewarm(const font::face &face, int size, const std::vector<u32> &codepoints, glyph_mode mode = glyph_mode::bitmap);
+
+			//glyphs of the face at the size with their bitmaps, in the format load() takes
+			std::vector<u8> save(const font::face &face, int size, glyph_mode mode = glyph_mode::bitmap) const;
+			//adds the glyphs saved before that are not in the atlas yet, false when the data is not a saved set
+			bool load(const font::face &face, int size, glyph_mode mode, const u8 *data, std::size_t data_size);
+
+			//pen adjustment between two codepoints, in pixels of the size the glyphs are rasterized at
+			int kerning(const font::face &face, int size, u32 left, u32 right, glyph_mode mode = glyph_mode::bitmap);
+			line_metrics_t line_metrics(const font::face &face, int size);
+
+			//grows on every eviction, glyphs looked up before it may be gone
+			u64 evictions() const;
+			std::size_t page_count() const;
+			size2i page_size(u32 page) const;
+
+			//passes the page with its area changed since the last sync, unless nothing changed
+			void sync_page(u32 page, const std::function<void(const page_t&, const coord2i&)> &upload);
+		};
+	}
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include "core.h"
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 namespace rfe
 {
@@ -10,33 +13,172 @@ namespace rfe
 		{
 			rgba8,
 			rgb8,
+			//4x4 blocks, 8 bytes each. rgb with 1 bit alpha
+			bc1,
+			//4x4 blocks, 16 bytes each. bc1 colors with interpolated alpha
+			bc3,
+			//4x4 blocks, 16 bytes each. rgba in one of 8 modes
+			bc7,
+			//4x4 blocks, 8 bytes each
+			etc2_rgb8,
+			//4x4 blocks, 16 bytes each. etc2 colors with eac alpha
+			etc2_rgba8,
 			//TODO
 		};
 
+		inline bool is_compressed(pixels_type type)
+		{
+			return type != pixels_type::rgba8 && type != pixels_type::rgb8;
+		}
+
+		//bytes of a block of compressed formats, of a pixel otherwise
+		inline std::size_t block_bytes(pixels_type type)
+		{
+			switch (type)
+			{
+			case pixels_type::rgb8: return 3;
+			case pixels_type::bc1:
+			case pixels_type::etc2_rgb8: return 8;
+			case pixels_type::bc3:
+			case pixels_type::bc7:
+			case pixels_type::etc2_rgba8: return 16;
+			default: return 4;
+			}
+		}
+
+		//compressed formats are stored in whole 4x4 blocks
+		inline std::size_t pixels_bytes(pixels_type type, size2i size)
+		{
+			if (is_compressed(type))
+			{
+				return std::size_t((size.width() + 3) / 4) * ((size.height() + 3) / 4) * block_bytes(type);
+			}
+
+			return std::size_t(size.width()) * size.height() * block_bytes(type);
+		}
+
+		//where the first row in memory is. textures are filled in memory order, top_left ones are sampled with flipped v
+		enum class image_origin : u8
+		{
+			bottom_left,
+			top_left
+		};
+
+		//pixels written while gpu copies of them exist. writers change them and mark the area under the mutex,
+		//the render thread uploads the marked area under it and clears it. one gpu copy follows it, like glyph atlas pages
+		struct image_updates
+		{
+			std::mutex mtx;
+			//of level 0, in memory rows
+			coord2i dirty;
+		};
+
 		class image
 		{
-			std::unique_ptr<char[]> m_pixels;
+			//the memory the pixels live in, owned or shared with the owner of a view
+			std::shared_ptr<const void> m_owner;
+			char *m_data = nullptr;
 			size2i m_size;
-			pixels_type m_type;
+			pixels_type m_type = pixels_type::rgba8;
+			int m_levels = 1;
+			//bytes between the rows of level 0, rows of blocks for compressed formats
+			std::size_t m_stride = 0;
+			image_origin m_origin = image_origin::bottom_left;
+			bool m_view = false;
+			std::atomic<u64> m_revision{ 0 };
+			std::shared_ptr<image_updates> m_updates;
 
 		public:
 			image() = default;
-			image(std::unique_ptr<char[]> pixels, size2i size, pixels_type type)
-				: m_pixels(std::move(pixels))
+			//levels are stored one after the other, each half the size of the previous one
+			image(std::unique_ptr<char[]> pixels, size2i size, pixels_type type, int levels = 1, image_origin origin = image_origin::bottom_left)
+				: m_data(pixels.get())
 				, m_size(size)
 				, m_type(type)
+				, m_levels(levels)
+				, m_origin(origin)
 			{
+				m_owner = std::shared_ptr<char>(pixels.release(), std::default_delete<char[]>());
+				m_stride = row_bytes(0);
 			}
 
 			image(const image&) = delete;
-			image(image&&) = default;
 			image& operator=(const image&) = delete;
-			image& operator=(image&&) = default;
+
+			image(image &&rhs)
+			{
+				*this = std::move(rhs);
+			}
+
+			image& operator=(image &&rhs)
+			{
+				m_owner = std::move(rhs.m_owner);
+				m_data = rhs.m_data;
+				m_size = rhs.m_size;
+				m_type = rhs.m_type;
+				m_levels = rhs.m_levels;
+				m_stride = rhs.m_stride;
+				m_origin = rhs.m_origin;
+				m_view = rhs.m_view;
+				m_revision = rhs.m_revision.load();
+				m_updates = std::move(rhs.m_updates);
+				rhs.m_data = nullptr;
+				return *this;
+			}
+
+			//pixels of someone else, nothing is copied. owner keeps them alive, without one the caller does.
+			//stride 0 is tight rows, a view holds level 0 only
+			static std::shared_ptr<image> view(const void *pixels, size2i size, pixels_type type, std::size_t stride = 0,
+				image_origin origin = image_origin::bottom_left, std::shared_ptr<const void> owner = nullptr)
+			{
+				auto result = std::make_shared<image>();
+				result->m_owner = std::move(owner);
+				result->m_data = (char*)pixels;
+				result->m_size = size;
+				result->m_type = type;
+				result->m_stride = stride ? stride : result->row_bytes(0);
+				result->m_origin = origin;
+				result->m_view = true;
+				return result;
+			}
+
+			//view of the area of level 0, position counted in memory rows. shares the memory of this image,
+			//compressed images are cut on whole blocks
+			std::shared_ptr<image> sub_image(point2i position, size2i size) const
+			{
+				std::size_t x = is_compressed(m_type) ? std::size_t(position.x() / 4) * block_bytes(m_type) : std::size_t(position.x()) * block_bytes(m_type);
+				std::size_t y = is_compressed(m_type) ? std::size_t(position.y() / 4) : std::size_t(position.y());
+
+				return view(m_data + y * m_stride + x, size, m_type, m_stride, m_origin, m_owner);
+			}
+
+			//tight rows in memory the copy owns, the origin is kept
+			image copy() const
+			{
+				auto pixels = std::make_unique<char[]>(bytes_tight());
+				char *to = pixels.get();
+
+				for (int y = 0; y < rows(0); ++y, to += row_bytes(0))
+				{
+					std::copy(row(y), row(y) + row_bytes(0), to);
+				}
+
+				if (m_levels > 1)
+				{
+					std::copy((const char*)level(1), (const char*)level(1) + (bytes() - level_offset(1)), to);
+				}
+
+				return image(std::move(pixels), m_size, m_type, m_levels, m_origin);
+			}
 
 			void clear()
 			{
-				m_pixels.reset();
+				m_owner.reset();
+				m_data = nullptr;
 				m_size = {};
+				m_levels = 1;
+				m_stride = 0;
+				m_view = false;
 			}
 
 			size2i size() const
@@ -49,9 +191,113 @@ namespace rfe
 				return m_type;
 			}
 
+			int levels() const
+			{
+				return m_levels;
+			}
+
+			std::size_t stride() const
+			{
+				return m_stride;
+			}
+
+			image_origin origin() const
+			{
+				return m_origin;
+			}
+
+			bool is_view() const
+			{
+				return m_view;
+			}
+
+			//every level in one run of bytes(), without padding between the rows
+			bool contiguous() const
+			{
+				return m_stride == row_bytes(0);
+			}
+
+			size2i level_size(int level) const
+			{
+				return{ std::max(m_size.width() >> level, 1), std::max(m_size.height() >> level, 1) };
+			}
+
+			//rows of pixels, of blocks for compressed formats
+			int rows(int level) const
+			{
+				int height = level_size(level).height();
+				return is_compressed(m_type) ? (height + 3) / 4 : height;
+			}
+
+			//without the padding
+			std::size_t row_bytes(int level) const
+			{
+				int width = level_size(level).width();
+				return is_compressed(m_type) ? std::size_t((width + 3) / 4) * block_bytes(m_type) : std::size_t(width) * block_bytes(m_type);
+			}
+
+			//row of level 0 in memory order, the top one first for top_left images
+			const char* row(int y) const
+			{
+				return m_data + std::size_t(y) * m_stride;
+			}
+
+			char* row(int y)
+			{
+				return m_data + std::size_t(y) * m_stride;
+			}
+
+			//levels after the first are tight
+			std::size_t level_offset(int level) const
+			{
+				if (level == 0)
+				{
+					return 0;
+				}
+
+				std::size_t result = m_stride * rows(0);
+
+				for (int i = 1; i < level; ++i)
+				{
+					result += pixels_bytes(m_type, level_size(i));
+				}
+
+				return result;
+			}
+
+			const void* level(int level_) const
+			{
+				return m_data + level_offset(level_);
+			}
+
+			//of every level
+			std::size_t bytes() const
+			{
+				return level_offset(m_levels);
+			}
+
+			//of every level once the padding is dropped
+			std::size_t bytes_tight() const
+			{
+				return bytes() - (m_stride - row_bytes(0)) * rows(0);
+			}
+
+			//levels down to 1x1
+			static int full_chain(size2i size)
+			{
+				int result = 1;
+
+				for (int extent = std::max(size.width(), size.height()); extent > 1; extent >>= 1)
+				{
+					++result;
+				}
+
+				return result;
+			}
+
 			bool empty() const
 			{
-				return m_pixels == nullptr;
+				return m_data == nullptr;
 			}
 
 			bool operator ==(std::nullptr_t) const
@@ -71,11 +317,30 @@ namespace rfe
 
 			void* get() const
 			{
-				return m_pixels.get();
+				return m_data;
+			}
+
+			//writers of the pixels bump it, gpu copies of an older revision are uploaded again
+			u64 revision() const
+			{
+				return m_revision;
+			}
+
+			void touch()
+			{
+				++m_revision;
+			}
+
+			//set by writers that change the pixels while they are drawn, null otherwise
+			const std::shared_ptr<image_updates>& updates() const
+			{
+				return m_updates;
 			}
 
-			//TODO:
-			//image copy() const {}
+			void updates(std::shared_ptr<image_updates> value)
+			{
+				m_updates = std::move(value);
+			}
 		};
 	}
 }
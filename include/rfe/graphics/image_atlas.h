@@ -0,0 +1,71 @@
+#pragma once
+#include "texture.h"
+#include "glyph_atlas.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rfe
+{
+	namespace graphics
+	{
+		//packs small images into shared rgba8 pages, textures remapped into a page draw from one gpu texture.
+		//callable from any thread
+		class image_atlas
+		{
+		public:
+			struct settings
+			{
+				size2i page_size{ 1024, 1024 };
+				//larger images keep their own texture
+				int max_image_size = 256;
+				//pixels around every image, filled with its edge pixels so filtering does not bleed the neighbours in.
+				//rounded up to a multiple of alignment
+				int padding = 2;
+				//placements and sizes are multiples of it. with mipmaps, 1 << levels keeps each image in whole texels of every level
+				int alignment = 1;
+			};
+
+		private:
+			struct page_t
+			{
+				std::shared_ptr<image> pixels;
+				skyline_packer packer;
+			};
+
+			struct placement_t
+			{
+				std::weak_ptr<image> source;
+				std::size_t page;
+				//of the image inside the page, padding excluded
+				point2i position;
+				size2i size;
+			};
+
+			settings m_settings;
+			mutable std::mutex m_mtx;
+			std::vector<page_t> m_pages;
+			std::unordered_map<const image*, placement_t> m_placements;
+
+			const placement_t* find(const std::shared_ptr<image> &image_) const;
+			//forgets the placements of released images and empties the pages nothing draws from anymore
+			void release_expired();
+			//index of the page that took the block, the page count when none had room
+			std::size_t pack(const size2i &packed, point2i &position);
+			void copy(page_t &page, const image &source, point2i position);
+
+		public:
+			image_atlas();
+			image_atlas(const settings &settings_);
+
+			//packs the image once, false when it is too large or of an unsupported type.
+			//the space of released images is reused when no page has room left
+			bool add(const std::shared_ptr<image> &image_);
+			//the texture with its image replaced by the page and its coords moved inside it, images not packed yet are added.
+			//unchanged when the image cannot be packed
+			texture remap(const texture &texture_);
+
+			std::size_t pages() const;
+		};
+	}
+}
@@ -168,6 +168,16 @@ OPENGL_PROC(PRIMITIVERESTARTINDEX, PrimitiveRestartIndex);
 
 OPENGL_PROC(GETINTEGER64V, GetInteger64v);
 
+//ARB_sync
+OPENGL_PROC(FENCESYNC, FenceSync);
+OPENGL_PROC(CLIENTWAITSYNC, ClientWaitSync);
+OPENGL_PROC(DELETESYNC, DeleteSync);
+
+//ARB_get_program_binary
+OPENGL_PROC(PROGRAMPARAMETERI, ProgramParameteri);
+OPENGL_PROC(GETPROGRAMBINARY, GetProgramBinary);
+OPENGL_PROC(PROGRAMBINARY, ProgramBinary);
+
 //KHR_debug
 //OPENGL_PROC(DEBUGMESSAGECONTROLARB, DebugMessageControlARB);
 //OPENGL_PROC(DEBUGMESSAGEINSERTARB, DebugMessageInsertARB);
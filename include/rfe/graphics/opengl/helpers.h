@@ -1887,6 +1887,40 @@ namespace rfe
 						validate();
 					}
 
+					//asks the driver to keep the binary of the next link
+					program& binary_retrievable(bool value = true)
+					{
+						glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, value ? GL_TRUE : GL_FALSE);
+						return *this;
+					}
+
+					//linked program in the driver format, empty when it has none
+					std::vector<u8> binary(GLenum &format) const
+					{
+						GLint length = 0;
+						glGetProgramiv(m_id, GL_PROGRAM_BINARY_LENGTH, &length);
+
+						std::vector<u8> result(length);
+
+						if (length)
+						{
+							glGetProgramBinary(m_id, length, &length, &format, result.data());
+							result.resize(length);
+						}
+
+						return result;
+					}
+
+					//false when the driver rejects it, the program can still be linked from sources then
+					bool binary(GLenum format, const void *data, std::size_t size)
+					{
+						glProgramBinary(m_id, format, data, (GLsizei)size);
+
+						GLint status = GL_FALSE;
+						glGetProgramiv(m_id, GL_LINK_STATUS, &status);
+						return status == GL_TRUE;
+					}
+
 					uint id() const
 					{
 						return m_id;
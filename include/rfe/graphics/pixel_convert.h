@@ -0,0 +1,43 @@
+#pragma once
+#include <rfe/core/types.h>
+#include <cstddef>
+
+namespace rfe
+{
+	namespace graphics
+	{
+		//row conversions between the layouts decoders produce and rgba8/rgb8.
+		//every kernel has a scalar version, x86 builds pick sse2 or avx2 ones at runtime
+		namespace convert
+		{
+			enum class isa : u8
+			{
+				scalar,
+				sse2,
+				avx2
+			};
+
+			//best set the cpu runs
+			isa supported();
+			//kernels used from now on, clamped to the supported set. benchmarks compare the paths with it
+			void use(isa set);
+			isa active();
+
+			//1, 2, 4 or 8 bit indices into a palette of rgba entries, 256 of them for 8 bit indices
+			void expand_palette(const u8 *indices, int bit_depth, const u8 *palette, u8 *rgba, std::size_t count);
+			//1, 2, 4 or 8 bit gray, lower depths are scaled up to the full range
+			void expand_gray(const u8 *gray, int bit_depth, u8 *rgba, std::size_t count);
+			void expand_gray_alpha(const u8 *gray_alpha, u8 *rgba, std::size_t count);
+			//big endian 16 bit samples, as png stores them, to their high byte
+			void narrow_16(const u8 *samples, u8 *result, std::size_t count);
+			void rgb_to_rgba(const u8 *rgb, u8 *rgba, std::size_t count);
+			//bgra to rgba and back, source and result may be the same
+			void swizzle_rb(const u8 *source, u8 *result, std::size_t count);
+			//source and result may be the same
+			void premultiply(const u8 *rgba, u8 *result, std::size_t count);
+			//colors through the srgb curve, alpha is linear in both
+			void srgb_to_linear(const u8 *rgba, float *linear, std::size_t count);
+			void linear_to_srgb(const float *linear, u8 *rgba, std::size_t count);
+		}
+	}
+}
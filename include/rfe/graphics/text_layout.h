@@ -0,0 +1,72 @@
+#pragma once
+#include "glyph_atlas.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace rfe
+{
+	namespace graphics
+	{
+		//shaped runs keyed by text, font and wrap width, relayout of unchanged text is a lookup
+		class text_layout
+		{
+			struct key_t
+			{
+				std::size_t text_hash;
+				void *face;
+				int size;
+				glyph_mode mode;
+				int width;
+				text_align align;
+
+				bool operator ==(const key_t &rhs) const
+				{
+					return text_hash == rhs.text_hash && face == rhs.face && size == rhs.size &&
+						mode == rhs.mode && width == rhs.width && align == rhs.align;
+				}
+			};
+
+			struct key_hasher
+			{
+				std::size_t operator()(const key_t &key) const
+				{
+					return key.text_hash ^ std::hash<void*>()(key.face) * 31 ^ (std::size_t(key.size) << 21) ^
+						(std::size_t(key.width) << 7) ^ (std::size_t(key.mode) << 4) ^ std::size_t(key.align);
+				}
+			};
+
+			struct entry_t
+			{
+				key_t key;
+				std::string text;
+				std::shared_ptr<const text_run_t> run;
+			};
+
+			glyph_atlas &m_atlas;
+
+			mutable std::mutex m_mtx;
+			//most recently used first
+			std::list<entry_t> m_entries;
+			std::unordered_map<key_t, std::list<entry_t>::iterator, key_hasher> m_index;
+			std::size_t m_capacity;
+
+			u64 m_hits = 0;
+			u64 m_misses = 0;
+
+			std::shared_ptr<text_run_t> shape(const std::string &text, const font::face &face, int size, glyph_mode mode, int width, text_align align);
+
+		public:
+			text_layout(glyph_atlas &atlas, std::size_t capacity = 1024);
+
+			std::shared_ptr<const text_run_t> layout(const std::string &text, const font::face &face, int size,
+				glyph_mode mode = glyph_mode::bitmap, int width = 0, text_align align = text_align::left);
+
+			u64 hits() const;
+			u64 misses() const;
+			void clear();
+		};
+	}
+}
@@ -51,6 +51,11 @@ namespace rfe
 				return *m_image.get();
 			}
 
+			const std::shared_ptr<class image>& image_ptr() const
+			{
+				return m_image;
+			}
+
 			void set_coords(const area2f& area)
 			{
 				set_coords(area_to_coords(area));
@@ -0,0 +1,18 @@
+#pragma once
+#include <rfe/graphics/image.h>
+#include <string>
+
+namespace rfe
+{
+	namespace loaders
+	{
+		namespace dds
+		{
+			//bc1, bc3, bc7 and 32 bit rgba or bgra surfaces with their mip levels, top_left as the file stores them
+			std::shared_ptr<graphics::image> load(const std::string &path);
+			std::shared_ptr<graphics::image> load(const u8 *data, std::size_t size);
+
+			bool is_dds(const u8 *data, std::size_t size);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <rfe/graphics/image.h>
+#include <rfe/core/thread_queue.h>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rfe
+{
+	namespace loaders
+	{
+		using image_future = std::shared_future<std::shared_ptr<graphics::image>>;
+
+		//decodes png, dds and ktx images on a pool of workers. requests for a path that is already being decoded share its result
+		class image_loader
+		{
+		public:
+			//receives null when the image could not be decoded
+			using callback_t = std::function<void(std::shared_ptr<graphics::image>)>;
+
+		private:
+			struct request_t
+			{
+				image_future future;
+				std::vector<callback_t> callbacks;
+			};
+
+			std::mutex m_mtx;
+			std::unordered_map<std::string, request_t> m_in_flight;
+			u64 m_deduplicated = 0;
+
+			thread_queue m_workers;
+
+			image_future request(const std::string &path, callback_t callback);
+
+		public:
+
+			image_loader(std::size_t threads = std::thread::hardware_concurrency());
+
+			//decode errors are rethrown by the future
+			image_future load(const std::string &path);
+			std::vector<image_future> load(const std::vector<std::string> &paths);
+			image_future load(std::vector<u8> buffer);
+
+			//the callback runs on the worker that decoded the image
+			void load(const std::string &path, callback_t callback);
+
+			//requests answered by a decode already in flight
+			u64 deduplicated();
+			void wait();
+		};
+
+		//shared loader for widgets that do not bring their own
+		image_loader& default_image_loader();
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <rfe/graphics/image.h>
+#include <string>
+
+namespace rfe
+{
+	namespace loaders
+	{
+		namespace ktx
+		{
+			//ktx 1 textures in bc1, bc3, bc7, etc2, etc2 with eac alpha, rgba8 or rgb8, with their mip levels.
+			//levels are kept in file order, ktx stores them the way opengl uploads them. bottom_left unless the orientation says t goes down
+			std::shared_ptr<graphics::image> load(const std::string &path);
+			std::shared_ptr<graphics::image> load(const u8 *data, std::size_t size);
+
+			bool is_ktx(const u8 *data, std::size_t size);
+		}
+	}
+}
@@ -8,8 +8,47 @@ namespace rfe
 	{
 		namespace png
 		{
+			//receives a decoded image a few rows at a time, top row first
+			class row_sink
+			{
+			public:
+				virtual ~row_sink() = default;
+
+				virtual void begin(size2i size, graphics::pixels_type type, std::size_t pitch) = 0;
+				//rows [first, first + count) of the image, pitch bytes apart. data is reused after the call
+				virtual void rows(int first, int count, const u8 *data) = 0;
+				//memory rows [first, first + count) can be decoded into, rows() is then called with it. null when the sink copies them
+				virtual u8* target(int first, int count) { return nullptr; }
+				virtual void end() {}
+			};
+
+			//collects the rows into a top_left image in decode order
+			class image_sink : public row_sink
+			{
+				std::unique_ptr<char[]> m_pixels;
+				size2i m_size;
+				graphics::pixels_type m_type = graphics::pixels_type::rgba8;
+				std::size_t m_pitch = 0;
+
+			public:
+				void begin(size2i size, graphics::pixels_type type, std::size_t pitch) override;
+				void rows(int first, int count, const u8 *data) override;
+				u8* target(int first, int count) override;
+
+				std::shared_ptr<graphics::image> image();
+			};
+
+			//rgb images come out as rgb8, palette, gray, alpha and 16 bit ones as rgba8.
+			//only rows_per_chunk rows are held at once, interlaced images have to be decoded whole first
+			void decode(std::istream& stream, row_sink &sink, int rows_per_chunk = 16);
+			//maps the file and decodes from the mapping
+			void decode(const std::string &path, row_sink &sink, int rows_per_chunk = 16);
+			//reads straight from the memory, nothing is copied before decoding. images inside asset packs can be decoded in place
+			void decode(const u8 *data, std::size_t size, row_sink &sink, int rows_per_chunk = 16);
+
 			std::shared_ptr<graphics::image> load(std::istream& stream);
 			std::shared_ptr<graphics::image> load(const std::string &path);
+			std::shared_ptr<graphics::image> load(const u8 *data, std::size_t size);
 		}
 	}
 }
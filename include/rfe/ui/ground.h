@@ -1,5 +1,6 @@
 #pragma once
 #include "widget.h"
+#include <rfe/loaders/image_loader.h>
 
 namespace rfe
 {
@@ -13,6 +14,9 @@ namespace rfe
 
 			ground();
 
+			//decodes the image on the loader workers and sets it as the texture once ready, keeps the current texture on failure
+			void load(const std::string &path, loaders::image_loader &loader = loaders::default_image_loader());
+
 		private:
 			std::weak_ptr<graphics::drawable> color_drawable;
 			std::weak_ptr<graphics::drawable> texture_drawable;
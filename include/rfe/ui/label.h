@@ -20,6 +20,9 @@ namespace rfe
 			data_event<std::string> text;
 			data_event<font::info> font;
 			data_event<color4f> color;
+			//lines longer than it wrap at word boundaries, 0 keeps them whole
+			data_event<int> wrap_width{ 0 };
+			data_event<graphics::text_align> align{ graphics::text_align::left };
 
 			label(const font::info &font = default_font);
 
@@ -31,9 +34,11 @@ namespace rfe
 			std::weak_ptr<graphics::drawable_text> m_text_drawable;
 			graphics::text_coords_t m_text_coords;
 			matrix4f m_matrix;
+			point2i m_matrix_position{};
+			size2i m_matrix_window_size{};
 
-			void set_parent(std::shared_ptr<widget> parent) override;
-
+			//sizes the label to its laid out text, once there is a draw context
+			void measure();
 			void dodraw() override;
 		};
 	}
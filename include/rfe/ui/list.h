@@ -3,26 +3,124 @@
 #include "widget.h"
 #include "list_entry.h"
 #include "ground.h"
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace rfe
 {
 	namespace ui
 	{
+		//vertical offsets of list rows, uniform rows are computed, variable ones kept as prefix sums
+		class list_row_index
+		{
+			std::size_t m_count = 0;
+			int m_row_height = 0;
+			std::vector<int> m_offsets;
+
+		public:
+			void uniform(std::size_t count, int row_height);
+			void variable(std::size_t count, const std::function<int(std::size_t)> &row_height);
+
+			std::size_t count() const;
+			int offset(std::size_t index) const;
+			int height(std::size_t index) const;
+			int total_height() const;
+
+			//row containing the offset, count() past the last row
+			std::size_t index_at(int offset) const;
+		};
+
+		//rows of a virtualized list, entries are created on demand and rebound to other rows while scrolling
+		struct list_source
+		{
+			std::function<std::size_t()> count;
+			std::function<std::shared_ptr<list_entry>()> make_entry;
+			std::function<void(list_entry&, std::size_t)> bind_entry;
+
+			//rows use list::row_height when not set
+			std::function<int(std::size_t)> row_height;
+		};
+
+		enum class list_selection_mode
+		{
+			single,
+			multiple
+		};
+
 		class list : public widget, public scrollable
 		{
+		public:
+			static constexpr std::size_t npos = ~std::size_t(0);
+
+		private:
+			struct entry_info
+			{
+				std::list<std::shared_ptr<list_entry>>::iterator it;
+				u64 order;
+			};
+
+			struct virtual_row
+			{
+				std::size_t index = npos;
+				std::shared_ptr<list_entry> entry;
+			};
+
 			std::weak_ptr<list_entry> m_selection;
 
 			std::list<std::shared_ptr<list_entry>> m_entries;
+			std::unordered_map<const list_entry*, entry_info> m_entry_index;
+			u64 m_next_order = 0;
 			bool m_clicked = false;
 
+			//selection is kept here, entries only mirror it
+			std::unordered_set<list_entry*> m_selected_entries;
+			std::unordered_set<std::size_t> m_selected_rows;
+			std::size_t m_anchor_row = npos;
+
+			list_source m_source;
+			list_row_index m_rows;
+			std::vector<virtual_row> m_virtual_rows;
+			std::size_t m_first_row = 0;
+			std::unordered_map<const list_entry*, std::size_t> m_entry_rows;
+			std::vector<std::shared_ptr<list_entry>> m_free_entries;
+
+			std::shared_ptr<list_entry> take_entry();
+			void update_rows(bool rebind = false);
+			std::shared_ptr<list_entry> bound_entry(std::size_t index) const;
+
+		protected:
+			size2i content_size() const override;
+
+		private:
+
+			void entry_selected(const std::shared_ptr<list_entry> &entry);
+			void entry_unselected(const std::shared_ptr<list_entry> &entry);
+			void select_row_entry(std::size_t index, const std::shared_ptr<list_entry> &entry);
+			void unselect_row_entry(std::size_t index);
+
 		public:
 			std::shared_ptr<ground> background = make_shared<ground>();
 
 			event<std::shared_ptr<list_entry>> onactivate;
 			event<std::shared_ptr<list_entry>> onselection_change;
 
+			data_event<int> row_height{ 20 };
+			data_event<int> overscan{ 4 };
+			data_event<list_selection_mode> selection_mode{ list_selection_mode::single };
+
 			list();
 
+			//switches the list to virtual mode, only rows around the viewport get entries
+			void source(list_source source_);
+			//count or row heights of the source changed, bound entries are refreshed
+			void reload();
+			bool is_virtual() const;
+
+			std::size_t row_of(const std::shared_ptr<list_entry> &entry) const;
+			void scroll_to(std::size_t index);
+
 			ui::sizer_flags& add_entry(std::shared_ptr<list_entry> widget);
 
 			bool remove_entry(std::shared_ptr<list_entry> widget);
@@ -30,6 +128,19 @@ namespace rfe
 			ui::sizer_flags& operator +=(std::shared_ptr<list_entry> widget);
 			bool operator -=(std::shared_ptr<list_entry> widget);
 			std::shared_ptr<list_entry> selection() const;
+			std::vector<std::shared_ptr<list_entry>> selected_entries() const;
+
+			//selects every entry between both ends, single mode selects only the last one
+			void select_range(const std::shared_ptr<list_entry> &from, const std::shared_ptr<list_entry> &to);
+			void clear_selection();
+
+			//selection of virtual rows, also for rows without a bound entry
+			void select_row(std::size_t index);
+			void unselect_row(std::size_t index);
+			void select_rows(std::size_t first, std::size_t last);
+			bool row_selected(std::size_t index) const;
+			std::size_t selected_row() const;
+			std::vector<std::size_t> selected_rows() const;
 		};
 	}
 }
@@ -2,31 +2,32 @@
 #include <rfe/ui/window.h>
 #include <rfe/graphics/draw_context.h>
 #include <rfe/graphics/opengl/helpers.h>
-#include <fstream>
+#include <rfe/graphics/glyph_atlas.h>
+#include <rfe/graphics/text_layout.h>
+#include <rfe/core/disk_cache.h>
+#include <rfe/core/mapped_file.h>
+#include "texture_cache.h"
 #include <string>
 
 namespace rfe
 {
 	static std::string file_to_string(const std::string& path)
 	{
-		std::ifstream ifs(path);
-		std::string result, line;
+		mapped_file file;
 
-		while (std::getline(ifs, line))
+		if (!file.open(path) || !file.data())
 		{
-			result += line + "\n";
+			return {};
 		}
 
-		return result;
+		return std::string((const char*)file.data(), file.size());
 	}
 
-	static std::vector<u8> file_to_binary(const std::string& path)
+	//the file is mapped, not copied, it stays readable until the result is destroyed
+	static mapped_file file_to_binary(const std::string& path)
 	{
-		std::ifstream ifs(path, std::ios::binary | std::ios::ate);
-		std::vector<u8> result((std::size_t)ifs.tellg());
-
-		ifs.seekg(ifs.beg);
-		ifs.read((char*)result.data(), result.size());
+		mapped_file result;
+		result.open(path);
 		return result;
 	}
 
@@ -40,21 +41,74 @@ namespace rfe
 				extern program_view texture_program;
 				extern program_view texture_sector_program;
 				extern program_view font_program;
+				extern program_view font_sdf_program;
 
 				namespace programs
 				{
+					//links the program from its sources, or takes the binary a previous run stored for this driver
+					inline void link_cached(program &program_, const std::string &fragment_path, const std::string &vertex_path, const disk_cache *cache)
+					{
+						std::string fragment = file_to_string(fragment_path);
+						std::string vertex = file_to_string(vertex_path);
+						std::string key;
+
+						program_.create();
+
+						//drivers without ARB_get_program_binary link from the sources every time
+						bool binaries = cache && glProgramBinary && glGetProgramBinary && glProgramParameteri;
+
+						if (binaries)
+						{
+							auto driver_string = [](GLenum name)
+							{
+								const GLubyte *value = glGetString(name);
+								return value ? std::string((const char*)value) : std::string{};
+							};
+
+							u64 driver = disk_cache::hash(driver_string(GL_VENDOR) + driver_string(GL_RENDERER) + driver_string(GL_VERSION));
+							u64 source = disk_cache::hash(vertex, disk_cache::hash(fragment));
+							key = disk_cache::key("program", { driver, source });
+
+							mapped_file file;
+
+							//format first, driver data after it
+							if (cache->load(key, file) && file.size() > sizeof(u32) &&
+								program_.binary(*(const u32*)file.data(), file.data() + sizeof(u32), file.size() - sizeof(u32)))
+							{
+								return;
+							}
+
+							program_.binary_retrievable();
+						}
+
+						program_
+							.attach(shader{ shader::type::fragment, fragment }.compile())
+							.attach(shader{ shader::type::vertex, vertex }.compile())
+							.bind_fragment_data_location("ocolor", 0)
+							.make();
+
+						if (binaries)
+						{
+							GLenum format = 0;
+							std::vector<u8> binary = program_.binary(format);
+
+							if (!binary.empty())
+							{
+								u32 format_ = format;
+								binary.insert(binary.begin(), (const u8*)&format_, (const u8*)&format_ + sizeof(format_));
+								cache->store(key, binary.data(), binary.size());
+							}
+						}
+					}
+
 					class color : public program
 					{
 					public:
 						struct entry_type { color4f color;  point4f position; };
 
-						color()
+						color(const disk_cache *cache = nullptr)
 						{
-							__glcheck create()
-								.attach(shader{ shader::type::fragment, file_to_string("shaders/gl/color.fp.glsl") }.compile())
-								.attach(shader{ shader::type::vertex, file_to_string("shaders/gl/color.vp.glsl") }.compile())
-								.bind_fragment_data_location("ocolor", 0)
-								.make();
+							__glcheck link_cached(*this, "shaders/gl/color.fp.glsl", "shaders/gl/color.vp.glsl", cache);
 						}
 					};
 
@@ -63,13 +117,9 @@ namespace rfe
 					public:
 						struct entry_type { point2f coord;  point4f position; };
 
-						texture()
+						texture(const disk_cache *cache = nullptr)
 						{
-							__glcheck create()
-								.attach(shader{ shader::type::fragment, file_to_string("shaders/gl/texture.fp.glsl") }.compile())
-								.attach(shader{ shader::type::vertex, file_to_string("shaders/gl/texture.vp.glsl") }.compile())
-								.bind_fragment_data_location("ocolor", 0)
-								.make();
+							__glcheck link_cached(*this, "shaders/gl/texture.fp.glsl", "shaders/gl/texture.vp.glsl", cache);
 						}
 					};
 
@@ -78,13 +128,9 @@ namespace rfe
 					public:
 						struct entry_type { point2f coord;  point4f position; };
 
-						texture_sector()
+						texture_sector(const disk_cache *cache = nullptr)
 						{
-							__glcheck create()
-								.attach(shader{ shader::type::fragment, file_to_string("shaders/gl/texture_sector.fp.glsl") }.compile())
-								.attach(shader{ shader::type::vertex, file_to_string("shaders/gl/texture_sector.vp.glsl") }.compile())
-								.bind_fragment_data_location("ocolor", 0)
-								.make();
+							__glcheck link_cached(*this, "shaders/gl/texture_sector.fp.glsl", "shaders/gl/texture_sector.vp.glsl", cache);
 						}
 					};
 
@@ -93,13 +139,20 @@ namespace rfe
 					public:
 						struct entry_type { point2f coord;  point4f position; };
 
-						font()
+						font(const disk_cache *cache = nullptr)
+						{
+							__glcheck link_cached(*this, "shaders/gl/font.fp.glsl", "shaders/gl/font.vp.glsl", cache);
+						}
+					};
+
+					class font_sdf : public program
+					{
+					public:
+						struct entry_type { point2f coord;  point4f position; };
+
+						font_sdf(const disk_cache *cache = nullptr)
 						{
-							__glcheck create()
-								.attach(shader{ shader::type::fragment, file_to_string("shaders/gl/font.fp.glsl") }.compile())
-								.attach(shader{ shader::type::vertex, file_to_string("shaders/gl/font.vp.glsl") }.compile())
-								.bind_fragment_data_location("ocolor", 0)
-								.make();
+							__glcheck link_cached(*this, "shaders/gl/font_sdf.fp.glsl", "shaders/gl/font.vp.glsl", cache);
 						}
 					};
 				}
@@ -122,9 +175,10 @@ namespace rfe
 				gl::draw_mode draw_mode;
 				int draw_count;
 				bool allow_sector_draw;
+				texture_cache::handle m_texture;
 
 			public:
-				drawable(const graphics::model &m);
+				drawable(const graphics::model &m, texture_cache &textures);
 				void draw(vector4f clip, const matrix4f& matrix_) override;
 			};
 
@@ -133,20 +187,16 @@ namespace rfe
 				draw_context *dc;
 				gl::vao vao;
 				gl::buffer vbo;
-				gl::texture texture;
-
-				struct char_info_t
-				{
-					area2f tex_coord;
-					coord2i coord;
-					point2i advance;
-				};
-
-				std::vector<char_info_t> char_info;
+				font::face m_face;
+				int m_size;
+				graphics::glyph_mode m_mode;
 
 			public:
 				drawable_text(draw_context *parent, const font::face& face);
-				graphics::text_coords_t prepare(const std::string &text) override;
+				using graphics::drawable_text::prepare;
+				std::shared_ptr<const graphics::text_run_t> layout(const std::string &text, int width = 0, graphics::text_align align = graphics::text_align::left) override;
+				graphics::text_coords_t prepare(const graphics::text_run_t &run) override;
+				bool outdated(const graphics::text_coords_t &coords) const override;
 				void draw(const graphics::text_coords_t &coords, const color4f &color, vector4f clip, const matrix4f& matrix_ = { 1 }) override;
 			};
 
@@ -157,6 +207,28 @@ namespace rfe
 				void *m_dc = nullptr;
 				void *m_gl_context = nullptr;
 
+				struct glyph_texture_t
+				{
+					gl::texture texture;
+					size2i size;
+				};
+
+				graphics::glyph_atlas m_glyph_atlas;
+				graphics::text_layout m_text_layout{ m_glyph_atlas };
+				std::vector<glyph_texture_t> m_glyph_textures;
+				texture_uploader m_uploader;
+				texture_cache m_texture_cache{ m_uploader };
+
+				std::shared_ptr<disk_cache> m_cache;
+				std::mutex m_face_hashes_mtx;
+				std::unordered_map<void*, u64> m_face_hashes;
+
+				u64 face_hash(const font::face &face);
+				void prewarm_size(const font::face &face, int size, const std::vector<u32> &codepoints, graphics::glyph_mode mode, const std::function<void()> &done);
+
+				//last, so pending prewarm work finishes before the atlas goes
+				thread_queue m_font_workers = make_thread_pool_queue();
+
 			public:
 				draw_context(window* parent);
 				draw_context(const draw_context&) = delete;
@@ -173,6 +245,34 @@ namespace rfe
 					return m_parent;
 				}
 
+				graphics::glyph_atlas& glyph_atlas()
+				{
+					return m_glyph_atlas;
+				}
+
+				graphics::text_layout& text_layout()
+				{
+					return m_text_layout;
+				}
+
+				//textures of image drawables, with their resident bytes and hit rate
+				texture_cache& textures()
+				{
+					return m_texture_cache;
+				}
+
+				//fills large textures over the next frames, with the bytes uploaded and their throughput
+				texture_uploader& uploader()
+				{
+					return m_uploader;
+				}
+
+				std::shared_ptr<const graphics::text_run_t> layout_text(const font::info &font_, const std::string &text, int width = 0, graphics::text_align align = graphics::text_align::left) override;
+				std::shared_future<void> prewarm(const font::face &face, const std::vector<int> &sizes, const std::string &characters = {}) override;
+
+				//texture of the atlas page with pending glyphs uploaded, render thread only
+				gl::texture& glyph_texture(u32 page);
+
 				std::weak_ptr<graphics::drawable> prepare(std::shared_ptr<void> parent, const graphics::model &m) override;
 				std::weak_ptr<graphics::drawable_text> prepare(std::shared_ptr<void> parent, const font::face &m) override;
 			};
@@ -0,0 +1,86 @@
+#pragma once
+#include <rfe/graphics/texture.h>
+#include "texture_uploader.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rfe
+{
+	namespace ui
+	{
+		namespace opengl
+		{
+			//gpu copies of images shared by the drawables of a context, found by image or by pixels.
+			//a texture is deleted once the last handle to it goes
+			class texture_cache
+			{
+			public:
+				struct entry_t
+				{
+					u32 id = 0;
+					size2i size;
+					std::size_t bytes = 0;
+					u64 content_hash = 0;
+					//rows are in the memory order of the image, top_left textures are sampled with flipped v
+					graphics::image_origin origin = graphics::image_origin::bottom_left;
+				};
+
+				using handle = std::shared_ptr<const entry_t>;
+
+			private:
+				struct image_key_t
+				{
+					std::weak_ptr<graphics::image> image;
+					std::weak_ptr<const entry_t> entry;
+					u64 revision;
+				};
+
+				//outlives the cache while handles remain, they delete nothing once the context is gone
+				struct state_t
+				{
+					std::mutex mtx;
+					std::unordered_map<const graphics::image*, image_key_t> by_image;
+					std::unordered_map<u64, std::weak_ptr<const entry_t>> by_content;
+					std::size_t resident_bytes = 0;
+					std::size_t textures = 0;
+					u64 hits = 0;
+					u64 misses = 0;
+				};
+
+				std::shared_ptr<state_t> m_state = std::make_shared<state_t>();
+				texture_uploader *m_uploader = nullptr;
+				std::size_t m_streamed_bytes = 0;
+
+				handle upload(const std::shared_ptr<graphics::image> &image, u64 content_hash);
+				//bytes resident on the gpu
+				static std::size_t upload_pixels(u32 id, const graphics::image &image);
+				//area of level 0, the other levels are generated again
+				static void update_pixels(u32 id, const graphics::image &image, const coord2i &area);
+				//another live image maps to the entry. state lock is held
+				bool shared(const graphics::image *image, const handle &entry) const;
+				bool streamed(const graphics::image &image) const;
+				void stream_pixels(const handle &entry, const std::shared_ptr<graphics::image> &image);
+
+			public:
+				texture_cache() = default;
+				//images of at least streamed_bytes are filled by the uploader over the next frames instead of at once
+				texture_cache(texture_uploader &uploader, std::size_t streamed_bytes = 256 * 1024);
+				texture_cache(const texture_cache&) = delete;
+				texture_cache& operator =(const texture_cache&) = delete;
+
+				//texture of the image, uploaded only when no live texture holds the same pixels,
+				//or again when the image changed since. images with updates get only the changed area. render thread only
+				handle acquire(const graphics::texture &texture);
+
+				std::size_t resident_bytes() const;
+				std::size_t textures() const;
+				u64 hits() const;
+				u64 misses() const;
+				//share of acquires served without an upload
+				double hit_rate() const;
+			};
+		}
+	}
+}
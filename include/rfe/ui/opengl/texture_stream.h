@@ -0,0 +1,83 @@
+#pragma once
+#include "draw_context.h"
+#include <rfe/loaders/png.h>
+#include <condition_variable>
+#include <mutex>
+
+namespace rfe
+{
+	namespace ui
+	{
+		namespace opengl
+		{
+			//uploads decoded rows into a texture on the render thread while the decoder goes on with the next ones
+			class texture_stream : public loaders::png::row_sink
+			{
+			public:
+				enum class mode
+				{
+					//rows are staged in memory and uploaded with glTexSubImage2D
+					sub_image,
+					//rows are written straight into mapped pixel unpack buffers
+					pixel_buffer
+				};
+
+			private:
+				struct chunk_t
+				{
+					std::vector<u8> staging;
+					gl::buffer pixel_buffer;
+					u8 *mapped = nullptr;
+					std::size_t capacity = 0;
+				};
+
+				std::shared_ptr<draw_context> m_dc;
+				mode m_mode;
+
+				std::vector<chunk_t> m_chunks;
+				std::vector<std::size_t> m_free_chunks;
+				std::mutex m_mtx;
+				std::condition_variable m_cv;
+
+				u32 m_texture = 0;
+				size2i m_size;
+				graphics::pixels_type m_type = graphics::pixels_type::rgba8;
+				std::size_t m_pitch = 0;
+
+				std::size_t take_chunk();
+				void release_chunk(std::size_t index);
+				void wait_uploads();
+				//render thread only
+				void upload(chunk_t &chunk, int first, int count, const u8 *pixels);
+				void remove_buffers();
+
+			public:
+				//chunks bounds the rows in flight, the decoder waits when all of them are being uploaded
+				texture_stream(std::shared_ptr<draw_context> dc, mode mode_ = mode::pixel_buffer, std::size_t chunks = 4);
+				texture_stream(const texture_stream&) = delete;
+				~texture_stream();
+
+				void begin(size2i size, graphics::pixels_type type, std::size_t pitch) override;
+				void rows(int first, int count, const u8 *data) override;
+				void end() override;
+
+				//complete once end() returned, deleting it is up to the caller
+				u32 texture() const
+				{
+					return m_texture;
+				}
+
+				size2i size() const
+				{
+					return m_size;
+				}
+
+				//the top row is the first one, samplers flip v
+				graphics::image_origin origin() const
+				{
+					return graphics::image_origin::top_left;
+				}
+			};
+		}
+	}
+}
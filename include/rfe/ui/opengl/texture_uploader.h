@@ -0,0 +1,117 @@
+#pragma once
+#include <rfe/graphics/image.h>
+#include <rfe/core/thread_queue.h>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rfe
+{
+	namespace ui
+	{
+		namespace opengl
+		{
+			//fills textures from a ring of pixel unpack memory. workers copy the pixels in, the render thread issues
+			//the texture copies a budget of bytes per frame and reuses the memory once their fence signals
+			class texture_uploader
+			{
+			public:
+				struct settings
+				{
+					//mapped once, images larger than it are uploaded from their own memory
+					std::size_t staging_bytes = 32 * 1024 * 1024;
+					//bytes of texture copies issued by one process(), at least a row is always issued
+					std::size_t frame_budget = 4 * 1024 * 1024;
+				};
+
+			private:
+				using clock = std::chrono::high_resolution_clock;
+
+				struct job_t
+				{
+					//the texture goes with its owner, jobs of expired owners are dropped
+					std::weak_ptr<const void> owner;
+					u32 texture;
+					size2i size;
+					graphics::pixels_type type;
+					std::size_t pitch;
+					//dropped once its pixels are in the ring
+					std::shared_ptr<const graphics::image> image;
+					bool mipmaps;
+					std::function<void()> done;
+
+					//offset in the ring, npos while it has no room there
+					std::size_t offset;
+					//the pixels are in the ring, set by the worker copying them
+					bool staged = false;
+					int next_row = 0;
+				};
+
+				struct allocation_t
+				{
+					std::size_t offset;
+					std::size_t size;
+					bool released;
+				};
+
+				struct batch_t
+				{
+					void *fence;
+					std::vector<std::size_t> allocations;
+					std::vector<std::function<void()>> done;
+					std::size_t bytes;
+					clock::time_point issued;
+				};
+
+				settings m_settings;
+
+				mutable std::mutex m_mtx;
+				std::deque<std::shared_ptr<job_t>> m_jobs;
+				//in ring order, space is reused from the front once released
+				std::deque<allocation_t> m_allocations;
+				std::size_t m_head = 0;
+				std::deque<batch_t> m_batches;
+
+				u32 m_buffer = 0;
+				u8 *m_mapped = nullptr;
+				bool m_initialized = false;
+
+				u64 m_uploaded_bytes = 0;
+				double m_busy_seconds = 0.0;
+				clock::time_point m_last_retire;
+
+				thread_queue m_workers = make_thread_pool_queue(1);
+
+				bool allocate(std::size_t size, std::size_t &offset);
+				void release(std::size_t offset);
+				void copy(std::shared_ptr<job_t> job);
+				void init();
+				void retire();
+
+			public:
+				texture_uploader();
+				texture_uploader(const settings &settings_);
+				texture_uploader(const texture_uploader&) = delete;
+				~texture_uploader();
+
+				//fills level 0 of the texture, its storage has to exist already. callable from any thread,
+				//done runs on the render thread once the copy finished on the gpu
+				void stage(std::weak_ptr<const void> owner, u32 texture, std::shared_ptr<const graphics::image> image,
+					bool mipmaps = false, std::function<void()> done = nullptr);
+
+				//render thread, once a frame. retires finished copies and issues the next ones
+				void process();
+				//render thread, drops pending jobs and the staging memory
+				void clear();
+
+				std::size_t pending() const;
+				u64 uploaded_bytes() const;
+				//bytes a second while copies were in flight
+				double throughput() const;
+			};
+		}
+	}
+}
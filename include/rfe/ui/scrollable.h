@@ -1,5 +1,8 @@
 #pragma once
 #include <rfe/core/event.h>
+#include <rfe/core/types.h>
+#include <atomic>
+#include <chrono>
 
 namespace rfe
 {
@@ -7,13 +10,41 @@ namespace rfe
 	{
 		class widget;
 
+		//scrolls the childs of the parent widget by translating them, the layout is left untouched
 		class scrollable
 		{
+			using clock = std::chrono::high_resolution_clock;
+
+			widget *m_parent;
+
+			bool m_dragging = false;
+			point2i m_drag_point{};
+			clock::time_point m_drag_time;
+			point2f m_velocity{};
+			std::atomic<std::size_t> m_fling_id{ 0 };
+
+		protected:
+			//size of everything that can be scrolled to, the content measured by the last arrange by default
+			virtual size2i content_size() const;
+
 		public:
 			data_event<int> vertical_scroll;
 			data_event<int> horizontal_scroll;
 
+			bool horizontal_drag = false;
+			bool vertical_drag = true;
+
+			//velocity of kinetic scrolling decays by e every time constant
+			std::chrono::milliseconds kinetic_time_constant{ 325 };
+
 			scrollable(widget *parent);
+			virtual ~scrollable() = default;
+
+			//follows a motion gesture and tracks its velocity
+			void drag(point2i start_point, point2i current_point);
+			//ends the gesture, scrolling goes on with the tracked velocity
+			void fling();
+			void stop_scrolling();
 		};
 	}
 }
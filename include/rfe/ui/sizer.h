@@ -149,7 +149,7 @@ namespace rfe
 			}
 
 		private:
-			void invalidate_widget(bool is_const = false);
+			void invalidate_widget();
 
 			friend class widget;
 		};
@@ -1,5 +1,6 @@
 #pragma once
 #include "sizer.h"
+#include "widget_store.h"
 
 #include <rfe/core/types.h>
 #include <rfe/core/event.h>
@@ -19,12 +20,6 @@ namespace rfe
 {
 	namespace ui
 	{
-		enum class recalc_sizers_type
-		{
-			set_constants,
-			set_relatives
-		};
-
 		class shared_read_mutex_read
 		{
 			std::mutex& m_mutex;
@@ -97,6 +92,10 @@ namespace rfe
 
 		std::shared_ptr<id_manager_t<u32>> id_manager();
 
+		//threads used to lay out independent sibling subtrees, 1 keeps the whole layout on the calling thread
+		void layout_threads(std::size_t count);
+		std::size_t layout_threads();
+
 		enum class orientation
 		{
 			horizontal,
@@ -109,6 +108,7 @@ namespace rfe
 		{
 		protected:
 			std::shared_ptr<id_manager_t<u32>> m_id_manager = id_manager();
+			std::shared_ptr<widget_store_t> m_store = widget_store();
 			bool m_invalidate = true;
 			std::shared_ptr<widget> m_parent;
 			data_event<std::shared_ptr<graphics::draw_context>> m_draw_context;
@@ -116,7 +116,6 @@ namespace rfe
 			std::shared_ptr<widget> m_top_widget = nullptr;
 			bool m_alive = true;
 			bool m_focused = false;
-			bool m_visible = false;
 			event_binder_t parent_event_binder;
 			u32 m_id = m_id_manager->new_id();
 
@@ -126,8 +125,21 @@ namespace rfe
 			bool m_touched = false;
 			point2i m_touch_point;
 			bool m_motion_started = false;
-			bool m_const_sizer_invalidated = true;
-			bool m_relative_sizer_invalidated = true;
+
+			//childs of this widget must be placed again
+			std::atomic<bool> m_arrange_invalidated{ true };
+			//this widget or one of its descendants must be placed again
+			std::atomic<bool> m_layout_invalidated{ true };
+			//size of the content found by the last arrange
+			size2i m_measured_size{};
+			//size assigned by the parent arrange, used to filter own changes from size.onchanged. cleared once seen
+			size2i m_arranged_size{ -1, -1 };
+			std::mutex m_arranged_size_mtx;
+			//placed by a parallel layout pass, applied to size and position by the thread that started it
+			size2i m_layout_size{};
+			point2i m_layout_position{};
+			bool m_layout_size_pending = false;
+			bool m_layout_position_pending = false;
 
 		public:
 			std::shared_ptr<const widget> shared_ptr() const;
@@ -166,11 +178,21 @@ namespace rfe
 				return m_motion_started;
 			}
 
-			matrix4f matrix{ 1.0f };
-			vector4f clip{};
+			matrix4f matrix() const
+			{
+				return m_store->matrix(m_id);
+			}
+
+			vector4f clip() const
+			{
+				return m_store->clip(m_id);
+			}
 
 			static matrix4f calc_matrix_for(coord2f coords, size2f global_size);
-			void calc_matrix();
+			void invalidate_transform();
+
+			void scroll_offset(point2i value);
+			point2i scroll_offset() const;
 
 			graphics::model model() const
 			{
@@ -187,7 +209,7 @@ namespace rfe
 			virtual ~widget();
 
 			void update_animation();
-			void update_sizers();
+			bool update_layout();
 			void update_childs();
 			void update();
 
@@ -298,9 +320,14 @@ namespace rfe
 			point2i absolute_to_local_point(point2i point, std::shared_ptr<const widget>* top_widget = nullptr) const;
 			point2i local_to_absolute_point(point2i point, std::shared_ptr<const widget>* top_widget = nullptr) const;
 
-			void refresh(bool is_const = false);
+			void refresh();
 			void draw(bool clear_and_flip = true);
 
+			size2i measured_size() const
+			{
+				return m_measured_size;
+			}
+
 		private:
 			class sizer_flags m_sizer_flags { this };
 
@@ -383,7 +410,14 @@ namespace rfe
 			int border_top = 5;
 			int border_bottom = 5;
 
-			void recalc_sizers(recalc_sizers_type type);
+			bool arrange();
+			bool update_childs_layout();
+			bool relative_free_descendants();
+			size2i layout_size() const;
+			point2i layout_position() const;
+			static void arrange_child_size(widget &child, size2i value);
+			static void arrange_child_position(widget &child, point2i value);
+			static void commit_layout(widget &target);
 		};
 	}
 }
@@ -0,0 +1,84 @@
+#pragma once
+#include <rfe/core/types.h>
+#include <rfe/core/id_manager.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rfe
+{
+	namespace ui
+	{
+		using namespace core;
+
+		//transform and visibility state of every widget, indexed by widget id.
+		//widget keeps it in sync and reads the results back, per frame passes sweep the arrays linearly
+		class widget_store_t
+		{
+		public:
+			static constexpr u32 no_parent = id_manager_t<u32>::bad_id;
+
+			enum flags : byte
+			{
+				is_used = 1 << 0,
+				is_shown = 1 << 1,
+				is_visible = 1 << 2,
+				transform_invalidated = 1 << 3,
+				transform_updated = 1 << 4
+			};
+
+		private:
+			mutable std::mutex m_mtx;
+
+			std::vector<point2i> m_positions;
+			std::vector<size2i> m_sizes;
+			std::vector<byte> m_flags;
+			std::vector<u32> m_parents;
+			std::vector<point2i> m_scroll_offsets;
+
+			std::vector<point2i> m_absolute_positions;
+			std::vector<size2i> m_top_sizes;
+			std::vector<matrix4f> m_matrices;
+			std::vector<vector4f> m_clips;
+
+			//rects recomputed by the current update_transforms, kept to reuse their memory
+			std::vector<mtx::rect_source> m_rect_sources;
+			std::vector<u32> m_rect_ids;
+
+			//used ids ordered by depth, so every parent comes before its childs
+			std::vector<u32> m_order;
+			std::vector<u32> m_depths;
+			bool m_order_invalidated = true;
+
+			void reserve(u32 id);
+			void rebuild_order();
+			u32 depth(u32 id);
+
+		public:
+			static matrix4f calc_matrix(coord2f coords, size2f global_size);
+
+			void add(u32 id);
+			void remove(u32 id);
+
+			void parent(u32 id, u32 parent);
+			void position(u32 id, point2i value);
+			void size(u32 id, size2i value);
+			void shown(u32 id, bool value);
+			//translation of the childs, applied without touching their layout
+			void scroll_offset(u32 id, point2i value);
+			void invalidate(u32 id);
+
+			point2i scroll_offset(u32 id) const;
+			point2i absolute_position(u32 id) const;
+			size2i top_size(u32 id) const;
+			matrix4f matrix(u32 id) const;
+			vector4f clip(u32 id) const;
+			bool visible(u32 id) const;
+
+			//recomputes absolute positions, visibility, clips and matrices of invalidated entries and their descendants
+			void update_transforms();
+		};
+
+		std::shared_ptr<widget_store_t> widget_store();
+	}
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include <rfe/core/thread_queue.h>
 #include <future>
+#include <atomic>
 
 namespace rfe
 {
@@ -11,10 +12,14 @@ namespace rfe
 		class window : public widget
 		{
 			void *m_handle = nullptr;
+			std::atomic<u64> m_coalesced_events{ 0 };
 
 		public:
 			thread_queue thread;
 
+			//block the events thread on the native connection while there is nothing to process
+			std::atomic<bool> wait_events{ false };
+
 			window(bool make_thread = true);
 			virtual ~window() = default;
 
@@ -40,6 +45,7 @@ namespace rfe
 
 		protected:
 			void create();
+			void process_events();
 			event_result doclose() override;
 
 			void remove_dc();
@@ -47,6 +53,12 @@ namespace rfe
 		public:
 			void focus() override;
 			void* handle() const;
+
+			//count of native events merged into a later one before dispatch
+			u64 coalesced_events() const
+			{
+				return m_coalesced_events;
+			}
 			using widget::operator+=;
 		};
 	}
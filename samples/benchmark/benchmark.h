@@ -0,0 +1,76 @@
+#pragma once
+#include <rfe/ui/widget.h>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace benchmark
+{
+	using clock = std::chrono::high_resolution_clock;
+
+	//average time of one call in microseconds
+	template<typename FunctionType>
+	double measure(std::size_t iterations, FunctionType function)
+	{
+		auto start = clock::now();
+
+		for (std::size_t i = 0; i < iterations; ++i)
+		{
+			function(i);
+		}
+
+		std::chrono::duration<double, std::micro> elapsed = clock::now() - start;
+		return elapsed.count() / iterations;
+	}
+
+	inline void report(const std::string &name, double value, const std::string &unit = "us")
+	{
+		std::cout << std::left << std::setw(56) << name << std::right << std::setw(14) << std::fixed << std::setprecision(2) << value << " " << unit << std::endl;
+	}
+
+	//columns of automatically sized groups of leaves on a 1920x1080 root, last_leaf gets the one added last
+	inline std::shared_ptr<rfe::ui::widget> make_grid_tree(int columns, int groups, int leaves, std::shared_ptr<rfe::ui::widget> *last_leaf = nullptr)
+	{
+		using namespace rfe;
+
+		auto root = ui::make_shared<ui::widget>();
+		root->orientation = ui::orientation::horizontal;
+		root->resize({ 1920, 1080 });
+
+		for (int column_index = 0; column_index < columns; ++column_index)
+		{
+			auto column = ui::make_shared<ui::widget>();
+			(*root += column).width(180).expand_vertical();
+
+			for (int group_index = 0; group_index < groups; ++group_index)
+			{
+				auto group = ui::make_shared<ui::widget>();
+				group->orientation = ui::orientation::horizontal;
+				(*column += group).auto_size();
+
+				for (int leaf_index = 0; leaf_index < leaves; ++leaf_index)
+				{
+					auto leaf = ui::make_shared<ui::widget>();
+					leaf->resize({ 2, 16 });
+					*group += leaf;
+
+					if (last_leaf)
+					{
+						*last_leaf = leaf;
+					}
+				}
+			}
+		}
+
+		return root;
+	}
+
+	void layout();
+	void transform();
+	void fonts();
+	void images();
+	void pixels();
+	void math();
+}
@@ -0,0 +1,107 @@
+#include "benchmark.h"
+#include <rfe/graphics/glyph_atlas.h>
+#include <rfe/graphics/text_layout.h>
+#include <rfe/core/thread_queue.h>
+#include <atomic>
+
+namespace benchmark
+{
+	using namespace rfe;
+
+	void fonts()
+	{
+		font::init();
+		font::face face = font::new_face("./resources/FreeSans.ttf");
+
+		const std::vector<int> sizes{ 10, 11, 12, 13, 14, 16, 18, 20, 24, 28, 32, 48 };
+		const std::string first_frame_text = "The quick brown fox jumps over the lazy dog 0123456789";
+
+		std::vector<u32> codepoints;
+
+		for (u32 codepoint = 0x20; codepoint < 0x7f; ++codepoint)
+		{
+			codepoints.push_back(codepoint);
+		}
+
+		//what the first frame pays when every glyph is rasterized on demand
+		double on_demand = measure(1, [&](std::size_t)
+		{
+			graphics::glyph_atlas atlas;
+			graphics::text_layout layout{ atlas };
+
+			for (int size : sizes)
+			{
+				layout.layout(first_frame_text, face, size);
+			}
+		});
+
+		report("fonts: first frame text, on demand", on_demand);
+
+		double serial = measure(1, [&](std::size_t)
+		{
+			graphics::glyph_atlas atlas;
+
+			for (int size : sizes)
+			{
+				atlas.prewarm(face, size, codepoints);
+			}
+		});
+
+		report("fonts: prewarm ascii x " + std::to_string(sizes.size()) + " sizes, 1 thread", serial);
+
+		graphics::glyph_atlas atlas;
+		graphics::text_layout layout{ atlas };
+
+		{
+			auto workers = make_thread_pool_queue();
+			const std::size_t chunk = 32;
+
+			double parallel = measure(1, [&](std::size_t)
+			{
+				std::atomic<std::size_t> remaining{ 0 };
+
+				for (int size : sizes)
+				{
+					for (std::size_t first = 0; first < codepoints.size(); first += chunk)
+					{
+						std::vector<u32> part(codepoints.begin() + first, codepoints.begin() + std::min(first + chunk, codepoints.size()));
+						++remaining;
+
+						workers.invoke([&, size, part]
+						{
+							atlas.prewarm(face, size, part);
+							--remaining;
+						}, std::launch::async);
+					}
+				}
+
+				while (remaining != 0)
+				{
+					std::this_thread::yield();
+				}
+			});
+
+			report("fonts: prewarm ascii x " + std::to_string(sizes.size()) + " sizes, " + std::to_string(std::thread::hardware_concurrency()) + " threads", parallel);
+		}
+
+		double warmed = measure(1, [&](std::size_t)
+		{
+			for (int size : sizes)
+			{
+				layout.layout(first_frame_text, face, size);
+			}
+		});
+
+		report("fonts: first frame text, prewarmed", warmed);
+
+		double cached = measure(100, [&](std::size_t)
+		{
+			for (int size : sizes)
+			{
+				layout.layout(first_frame_text, face, size);
+			}
+		});
+
+		report("fonts: same text laid out again", cached);
+	}
+}
@@ -0,0 +1,117 @@
+#include "benchmark.h"
+#include <rfe/loaders/image_loader.h>
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace benchmark
+{
+	using namespace rfe;
+
+	static std::vector<std::string> list_png(const std::string &directory)
+	{
+		std::vector<std::string> result;
+
+#ifdef _WIN32
+		WIN32_FIND_DATAA data;
+		HANDLE find = FindFirstFileA((directory + "\\*.png").c_str(), &data);
+
+		if (find != INVALID_HANDLE_VALUE)
+		{
+			do
+			{
+				result.push_back(directory + "/" + data.cFileName);
+			} while (FindNextFileA(find, &data));
+
+			FindClose(find);
+		}
+#else
+		if (DIR *dir = opendir(directory.c_str()))
+		{
+			while (dirent *entry = readdir(dir))
+			{
+				std::string name = entry->d_name;
+
+				if (name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0)
+				{
+					result.push_back(directory + "/" + name);
+				}
+			}
+
+			closedir(dir);
+		}
+#endif
+
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	void images()
+	{
+		const char *directory = std::getenv("RFE_BENCHMARK_IMAGES");
+		auto paths = list_png(directory ? directory : "./resources/images");
+
+		if (paths.empty())
+		{
+			std::cout << "images: no png found, set RFE_BENCHMARK_IMAGES to a directory of them" << std::endl;
+			return;
+		}
+
+		std::size_t threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+		static constexpr std::size_t iterations = 3;
+
+		//decodes everything and counts the failures
+		auto decode = [&](loaders::image_loader &loader)
+		{
+			std::size_t failed = 0;
+
+			for (auto &future : loader.load(paths))
+			{
+				try
+				{
+					future.get();
+				}
+				catch (...)
+				{
+					++failed;
+				}
+			}
+
+			return failed;
+		};
+
+		//untimed, so the files are in the page cache for every configuration and not only the later ones
+		{
+			loaders::image_loader loader{ threads };
+			std::size_t failed = decode(loader);
+
+			if (failed)
+			{
+				std::cout << "images: " << failed << " failed to decode" << std::endl;
+			}
+		}
+
+		for (std::size_t count : { std::size_t(1), threads })
+		{
+			loaders::image_loader loader{ count };
+
+			double elapsed = measure(iterations, [&](std::size_t)
+			{
+				decode(loader);
+			});
+
+			report("images: decode " + std::to_string(paths.size()) + " png, " + std::to_string(count) + " threads", elapsed / 1000.0, "ms");
+
+			if (count == threads)
+			{
+				break;
+			}
+		}
+	}
+}
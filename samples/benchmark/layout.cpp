@@ -0,0 +1,84 @@
+#include "benchmark.h"
+#include <rfe/ui/widget.h>
+
+namespace benchmark
+{
+	using namespace rfe;
+
+	static void refresh_all(ui::widget &widget_)
+	{
+		widget_.refresh();
+
+		for (auto &child : widget_.childs())
+		{
+			refresh_all(*child);
+		}
+	}
+
+	void layout()
+	{
+		static constexpr int columns = 10;
+		static constexpr int groups = 10;
+		static constexpr int leaves = 50;
+		static constexpr std::size_t iterations = 200;
+
+		//10 columns x 10 automatically sized groups x 50 leaves = 5000 leaves
+		std::shared_ptr<ui::widget> resized_leaf;
+		auto root = make_grid_tree(columns, groups, leaves, &resized_leaf);
+
+		root->update_layout();
+
+		const size2i leaf_sizes[2] = { { 2, 24 }, { 2, 16 } };
+
+		report("layout: 5000 leaves, single leaf resize, incremental", measure(iterations, [&](std::size_t i)
+		{
+			resized_leaf->resize(leaf_sizes[i % 2]);
+			root->update_layout();
+		}));
+
+		report("layout: 5000 leaves, single leaf resize, whole tree", measure(iterations, [&](std::size_t i)
+		{
+			resized_leaf->resize(leaf_sizes[i % 2]);
+			refresh_all(*root);
+			root->update_layout();
+		}));
+
+		//wide tree: 64 expanded columns of 8 groups x 16 leaves, every column is an independent subtree
+		auto wide_root = ui::make_shared<ui::widget>();
+		wide_root->orientation = ui::orientation::horizontal;
+		wide_root->resize({ 1920, 1080 });
+
+		for (int column_index = 0; column_index < 64; ++column_index)
+		{
+			auto column = ui::make_shared<ui::widget>();
+			(*wide_root += column).width(30).expand_vertical();
+
+			for (int group_index = 0; group_index < 8; ++group_index)
+			{
+				auto group = ui::make_shared<ui::widget>();
+				group->orientation = ui::orientation::horizontal;
+				(*column += group).auto_size();
+
+				for (int leaf_index = 0; leaf_index < 16; ++leaf_index)
+				{
+					auto leaf = ui::make_shared<ui::widget>();
+					leaf->resize({ 1, 16 });
+					*group += leaf;
+				}
+			}
+		}
+
+		for (std::size_t threads : { 1, 2, 4, 8 })
+		{
+			ui::layout_threads(threads);
+
+			report("layout: 8769 widgets wide, whole tree, " + std::to_string(threads) + " threads", measure(iterations / 4, [&](std::size_t i)
+			{
+				refresh_all(*wide_root);
+				wide_root->update_layout();
+			}));
+		}
+
+		ui::layout_threads(1);
+	}
+}
@@ -0,0 +1,11 @@
+#include "benchmark.h"
+
+int main()
+{
+	benchmark::layout();
+	benchmark::transform();
+	benchmark::fonts();
+	benchmark::images();
+	benchmark::pixels();
+	benchmark::math();
+}
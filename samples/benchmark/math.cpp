@@ -0,0 +1,124 @@
+#include "benchmark.h"
+#include <rfe/core/types.h>
+#include <vector>
+
+namespace benchmark
+{
+	using namespace rfe;
+
+	//results are summed so the calls are not optimized away
+	static float checksum(const matrix4f &value)
+	{
+		return value[0][0] + value[1][1] + value[2][2] + value[3][3];
+	}
+
+	static vector3f xyz(const vector4f &value)
+	{
+		return{ value[0], value[1], value[2] };
+	}
+
+	void math()
+	{
+		const std::size_t count = 4096;
+		const std::size_t iterations = 2000;
+
+		std::vector<matrix4f> matrices(count);
+		std::vector<vector4f> vectors(count);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			for (int row = 0; row < 4; ++row)
+			{
+				for (int column = 0; column < 4; ++column)
+				{
+					matrices[i][row][column] = float((i * 7 + row * 5 + column * 3) % 17) - 8.f + (row == column ? 20.f : 0.f);
+				}
+
+				vectors[i][row] = float((i + row) % 11);
+			}
+		}
+
+		float sum = 0.f;
+		const char *path = simd::enabled ? "simd" : "generic (no simd)";
+
+		auto run = [&](const std::string &name, auto function)
+		{
+			double elapsed = measure(iterations, [&](std::size_t)
+			{
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					sum += function(i);
+				}
+			});
+
+			report("math: " + name, count / elapsed, "M/s");
+		};
+
+		run("matrix4f multiply, generic", [&](std::size_t i) { return checksum(generic::multiply(matrices[i], matrices[(i + 1) % count])); });
+		run(std::string("matrix4f multiply, ") + path, [&](std::size_t i) { return checksum(matrices[i] * matrices[(i + 1) % count]); });
+
+		run("vector4f transform, generic", [&](std::size_t i) { return generic::transform(vectors[i], matrices[i])[3]; });
+		run(std::string("vector4f transform, ") + path, [&](std::size_t i) { return (vectors[i] * matrices[i])[3]; });
+
+		run("matrix4f inverse, generic", [&](std::size_t i) { return checksum(generic::inverse(matrices[i])); });
+		run(std::string("matrix4f inverse, ") + path, [&](std::size_t i) { return checksum(inverse(matrices[i])); });
+
+		run("scale_offset, generic", [&](std::size_t i) { return checksum(generic::scale_offset(xyz(vectors[i]), xyz(vectors[(i + 1) % count]))); });
+		run(std::string("scale_offset, ") + path, [&](std::size_t i) { return checksum(mtx::scale_offset(xyz(vectors[i]), xyz(vectors[(i + 1) % count]))); });
+
+		//the loop the vector operators run for every other type
+		run("vector4f multiply add, generic", [&](std::size_t i)
+		{
+			vector4f result;
+
+			for (int j = 0; j < 4; ++j)
+			{
+				result[j] = vectors[i][j] * vectors[(i + 1) % count][j] + vectors[(i + 2) % count][j] / 3.f;
+			}
+
+			return result[2];
+		});
+		run(std::string("vector4f multiply add, ") + path, [&](std::size_t i) { return (vectors[i] * vectors[(i + 1) % count] + vectors[(i + 2) % count] / 3.f)[2]; });
+
+		//widget rects, one sweep over all of them
+		std::vector<mtx::rect_source> rects(count);
+		std::vector<mtx::transform2f> transforms(count);
+		std::vector<vector4f> clips(count);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			rects[i].position = { float(i % 37), float(i % 23) };
+			rects[i].parent_offset = { float(i % 640), float(i % 480) };
+			rects[i].size = { float(8 + i % 200), float(8 + i % 120) };
+			rects[i].parent_size = { 640.f, 480.f };
+			rects[i].global_size = { 1920.f, 1080.f };
+		}
+
+		auto run_rects = [&](const std::string &name, auto function)
+		{
+			double elapsed = measure(iterations, [&](std::size_t) { function(); });
+			sum += clips[count / 2][0];
+			report("math: " + name, count / elapsed, "M/s");
+		};
+
+		run_rects("rect matrices, one at a time", [&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				mtx::rect_transform(rects[i], matrices[i], clips[i]);
+			}
+		});
+		run_rects(std::string("rect matrices, batch ") + path, [&] { mtx::rect_transforms(rects.data(), count, matrices.data(), clips.data()); });
+
+		run_rects("rect transform2f, one at a time", [&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				mtx::rect_transform(rects[i], transforms[i], clips[i]);
+			}
+		});
+		run_rects(std::string("rect transform2f, batch ") + path, [&] { mtx::rect_transforms(rects.data(), count, transforms.data(), clips.data()); });
+
+		report("math: checksum", sum, "");
+	}
+}
@@ -0,0 +1,57 @@
+#include "benchmark.h"
+#include <rfe/graphics/pixel_convert.h>
+#include <functional>
+#include <vector>
+
+namespace benchmark
+{
+	using namespace rfe;
+	namespace convert = graphics::convert;
+
+	void pixels()
+	{
+		const std::size_t count = 1024 * 1024;
+		const std::size_t iterations = 20;
+		const char *names[] = { "scalar", "sse2", "avx2" };
+
+		std::vector<u8> source(count * 8);
+		std::vector<u8> result(count * 4);
+		std::vector<float> linear(count * 4);
+
+		for (std::size_t i = 0; i < source.size(); ++i)
+		{
+			source[i] = u8(i * 2654435761u >> 24);
+		}
+
+		for (std::size_t i = 0; i < linear.size(); ++i)
+		{
+			linear[i] = float(source[i]) / 255.f;
+		}
+
+		std::pair<const char*, std::function<void()>> kernels[] =
+		{
+			{ "expand palette", [&] { convert::expand_palette(source.data(), 8, source.data() + count, result.data(), count); } },
+			{ "expand gray", [&] { convert::expand_gray(source.data(), 8, result.data(), count); } },
+			{ "expand gray alpha", [&] { convert::expand_gray_alpha(source.data(), result.data(), count); } },
+			{ "narrow 16 bit rgba", [&] { convert::narrow_16(source.data(), result.data(), count * 4); } },
+			{ "rgb to rgba", [&] { convert::rgb_to_rgba(source.data(), result.data(), count); } },
+			{ "swizzle bgra", [&] { convert::swizzle_rb(source.data(), result.data(), count); } },
+			{ "premultiply", [&] { convert::premultiply(source.data(), result.data(), count); } },
+			{ "srgb to linear", [&] { convert::srgb_to_linear(source.data(), linear.data(), count); } },
+			{ "linear to srgb", [&] { convert::linear_to_srgb(linear.data(), result.data(), count); } },
+		};
+
+		for (auto &kernel : kernels)
+		{
+			for (int set = 0; set <= int(convert::supported()); ++set)
+			{
+				convert::use(convert::isa(set));
+
+				double elapsed = measure(iterations, [&](std::size_t) { kernel.second(); });
+				report(std::string("pixels: ") + kernel.first + ", " + names[set], count / elapsed, "MPixels/s");
+			}
+		}
+
+		convert::use(convert::supported());
+	}
+}
@@ -0,0 +1,69 @@
+#include "benchmark.h"
+#include <rfe/ui/widget.h>
+#include <rfe/ui/scrollable.h>
+
+namespace benchmark
+{
+	using namespace rfe;
+
+	struct scroll_box : ui::widget, ui::scrollable
+	{
+		scroll_box() : scrollable{ this }
+		{
+		}
+	};
+
+	void transform()
+	{
+		static constexpr int columns = 10;
+		static constexpr int groups = 10;
+		static constexpr int leaves = 50;
+		static constexpr std::size_t iterations = 200;
+
+		std::shared_ptr<ui::widget> moved_leaf;
+		auto root = make_grid_tree(columns, groups, leaves, &moved_leaf);
+
+		root->update_layout();
+
+		auto store = ui::widget_store();
+		store->update_transforms();
+
+		const size2i root_sizes[2] = { { 1920, 1200 }, { 1920, 1080 } };
+		const point2i leaf_positions[2] = { { 4, 0 }, { 2, 0 } };
+
+		report("transform: 5000 leaves, root resize", measure(iterations, [&](std::size_t i)
+		{
+			root->resize(root_sizes[i % 2]);
+			store->update_transforms();
+		}));
+
+		report("transform: 5000 leaves, single leaf move", measure(iterations, [&](std::size_t i)
+		{
+			moved_leaf->move(leaf_positions[i % 2]);
+			store->update_transforms();
+		}));
+
+		//scrolling translates the childs of the box, the layout is not invalidated
+		auto box_root = ui::make_shared<ui::widget>();
+		box_root->resize({ 1920, 1080 });
+
+		auto box = ui::make_shared<scroll_box>();
+		(*box_root += box).fill();
+
+		for (int row_index = 0; row_index < 5000; ++row_index)
+		{
+			auto row = ui::make_shared<ui::widget>();
+			(*box += row).height(20).expand_horizontal();
+		}
+
+		box_root->update_layout();
+		store->update_transforms();
+
+		report("transform: scroll 5000 rows", measure(iterations, [&](std::size_t i)
+		{
+			box->vertical_scroll = -int(i % 100) * 10;
+			box_root->update_layout();
+			store->update_transforms();
+		}));
+	}
+}
@@ -0,0 +1,150 @@
+#include <rfe/core/disk_cache.h>
+#include <atomic>
+#include <cstdio>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rfe
+{
+	inline namespace core
+	{
+		static void make_directory(const std::string &path)
+		{
+			if (path.empty())
+			{
+				return;
+			}
+
+#ifdef _WIN32
+			CreateDirectoryA(path.c_str(), nullptr);
+#else
+			mkdir(path.c_str(), 0755);
+#endif
+		}
+
+		disk_cache::disk_cache(const std::string &directory)
+			: m_directory(directory)
+		{
+			while (!m_directory.empty() && (m_directory.back() == '/' || m_directory.back() == '\\'))
+			{
+				m_directory.pop_back();
+			}
+
+			//every parent first, existing ones are left alone
+			for (std::size_t i = 1; i < m_directory.length(); ++i)
+			{
+				if (m_directory[i] == '/' || m_directory[i] == '\\')
+				{
+					make_directory(m_directory.substr(0, i));
+				}
+			}
+
+			make_directory(m_directory);
+		}
+
+		bool disk_cache::load(const std::string &key, mapped_file &result) const
+		{
+			return result.open(m_directory + "/" + key);
+		}
+
+		bool disk_cache::store(const std::string &key, const void *data, std::size_t size) const
+		{
+			std::string path = m_directory + "/" + key;
+			//every writer fills its own file, the rename publishes one whole entry
+			static std::atomic<u64> writers{ 0 };
+#ifdef _WIN32
+			u64 process = GetCurrentProcessId();
+#else
+			u64 process = (u64)getpid();
+#endif
+			std::string temporary_path = path + "." + std::to_string(process) + "." + std::to_string(writers++) + ".tmp";
+
+			FILE *file = std::fopen(temporary_path.c_str(), "wb");
+
+			if (!file)
+			{
+				return false;
+			}
+
+			bool written = std::fwrite(data, 1, size, file) == size;
+			written = std::fclose(file) == 0 && written;
+
+			if (!written)
+			{
+				std::remove(temporary_path.c_str());
+				return false;
+			}
+
+#ifdef _WIN32
+			if (!MoveFileExA(temporary_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+#else
+			if (std::rename(temporary_path.c_str(), path.c_str()) != 0)
+#endif
+			{
+				std::remove(temporary_path.c_str());
+				return false;
+			}
+
+			return true;
+		}
+
+		void disk_cache::remove(const std::string &key) const
+		{
+			std::remove((m_directory + "/" + key).c_str());
+		}
+
+		u64 disk_cache::hash(const void *data, std::size_t size, u64 seed)
+		{
+			const u8 *bytes = (const u8*)data;
+
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				seed = (seed ^ bytes[i]) * 1099511628211ULL;
+			}
+
+			return seed;
+		}
+
+		u64 disk_cache::hash(const std::string &text, u64 seed)
+		{
+			return hash(text.data(), text.length(), seed);
+		}
+
+		u64 disk_cache::file_hash(const std::string &path)
+		{
+			mapped_file file;
+
+			if (!file.open(path))
+			{
+				return 0;
+			}
+
+			return hash(file.data(), file.size());
+		}
+
+		std::string disk_cache::key(const std::string &kind, std::initializer_list<u64> parts)
+		{
+			static const char digits[] = "0123456789abcdef";
+
+			std::string result = kind;
+
+			for (u64 part : parts)
+			{
+				result += '-';
+
+				for (int shift = 60; shift >= 0; shift -= 4)
+				{
+					result += digits[(part >> shift) & 0xf];
+				}
+			}
+
+			return result;
+		}
+	}
+}
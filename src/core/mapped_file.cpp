@@ -0,0 +1,155 @@
+#include <rfe/core/mapped_file.h>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rfe
+{
+	inline namespace core
+	{
+		mapped_file::mapped_file(mapped_file &&rhs)
+		{
+			*this = std::move(rhs);
+		}
+
+		mapped_file::~mapped_file()
+		{
+			close();
+		}
+
+		mapped_file& mapped_file::operator =(mapped_file &&rhs)
+		{
+			if (this != &rhs)
+			{
+				close();
+
+				std::swap(m_file, rhs.m_file);
+				std::swap(m_mapping, rhs.m_mapping);
+				std::swap(m_data, rhs.m_data);
+				std::swap(m_size, rhs.m_size);
+			}
+
+			return *this;
+		}
+
+		bool mapped_file::open(const std::string &path)
+		{
+			close();
+
+#ifdef _WIN32
+			HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			LARGE_INTEGER size;
+
+			if (!GetFileSizeEx(file, &size))
+			{
+				CloseHandle(file);
+				return false;
+			}
+
+			m_file = file;
+			m_size = (std::size_t)size.QuadPart;
+
+			//empty files cannot be mapped, they stay open with no data
+			if (m_size == 0)
+			{
+				return true;
+			}
+
+			m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+			if (m_mapping)
+			{
+				m_data = (const u8*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+			}
+#else
+			int file = ::open(path.c_str(), O_RDONLY);
+
+			if (file < 0)
+			{
+				return false;
+			}
+
+			struct stat info;
+
+			if (fstat(file, &info) != 0)
+			{
+				::close(file);
+				return false;
+			}
+
+			m_file = (void*)(std::intptr_t)(file + 1);
+			m_size = (std::size_t)info.st_size;
+
+			//empty files cannot be mapped, they stay open with no data
+			if (m_size == 0)
+			{
+				return true;
+			}
+
+			void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+			if (data != MAP_FAILED)
+			{
+				m_data = (const u8*)data;
+			}
+#endif
+
+			if (!m_data)
+			{
+				close();
+				return false;
+			}
+
+			return true;
+		}
+
+		void mapped_file::close()
+		{
+#ifdef _WIN32
+			if (m_data)
+			{
+				UnmapViewOfFile(m_data);
+			}
+
+			if (m_mapping)
+			{
+				CloseHandle(m_mapping);
+			}
+
+			if (m_file)
+			{
+				CloseHandle(m_file);
+			}
+#else
+			if (m_data)
+			{
+				munmap((void*)m_data, m_size);
+			}
+
+			if (m_file)
+			{
+				::close(int((std::intptr_t)m_file - 1));
+			}
+#endif
+
+			m_file = nullptr;
+			m_mapping = nullptr;
+			m_data = nullptr;
+			m_size = 0;
+		}
+	}
+}
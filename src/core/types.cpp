@@ -54,4 +54,116 @@ namespace rfe
 			return (f32&)result;
 		}
 	}
+
+	namespace mtx
+	{
+		static_assert(sizeof(rect_source) == 10 * sizeof(float) && sizeof(transform2f) == 4 * sizeof(float), "rects are read and written as floats");
+
+		static void rect_values(const rect_source &source, core::point2f &scale, core::point2f &translate, core::vector4f &clip)
+		{
+			core::point2f absolute = source.parent_offset + source.position;
+			core::point2f clip_top = (source.parent_offset * 2.f) / source.global_size - 1.f;
+			core::point2f clip_bottom = ((source.parent_offset + source.parent_size) * 2.f) / source.global_size - 1.f;
+
+			scale = source.size / source.global_size;
+			translate = absolute * 2.f / source.global_size - (core::point2f{ 1.f, 1.f } - scale);
+			clip = { clip_top.x(), clip_top.y(), clip_bottom.x(), clip_bottom.y() };
+		}
+
+		void rect_transform(const rect_source &source, core::matrix4f &matrix, core::vector4f &clip)
+		{
+			core::point2f scale, translate;
+			rect_values(source, scale, translate, clip);
+			matrix = scale_offset({ scale.x(), scale.y(), 1.f }, { translate.x(), -translate.y(), 0.f });
+		}
+
+		void rect_transform(const rect_source &source, transform2f &transform, core::vector4f &clip)
+		{
+			core::point2f scale, translate;
+			rect_values(source, scale, translate, clip);
+			transform = { scale, { translate.x(), -translate.y() } };
+		}
+
+		//lanes hold x and y of the rect, then of its parent. the same operations as rect_values, so the results match
+		template<typename Store>
+		static void rect_kernel(const rect_source *sources, std::size_t count, const u32 *indices, Store store)
+		{
+			using namespace core::simd;
+
+			const f32x4 zero = splat(0.f);
+			const f32x4 one = splat(1.f);
+			const f32x4 two = splat(2.f);
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				//position and parent offset, size and parent size, global size twice
+				const float *source = (const float*)&sources[i];
+				f32x4 positions = load(source);
+				f32x4 sizes = load(source + 4);
+				f32x4 global = load_pair(source + 8);
+
+				positions = add(positions, high_halves(positions, zero));
+
+				f32x4 scale = div(sizes, global);
+				f32x4 doubled = div(mul(positions, two), global);
+				f32x4 translate = sub(doubled, sub(one, scale));
+				f32x4 clip_top = sub(doubled, one);
+				f32x4 clip_bottom = sub(div(mul(add(positions, sizes), two), global), one);
+
+				store(indices ? indices[i] : i, scale, translate, high_halves(clip_top, clip_bottom));
+			}
+		}
+
+		void rect_transforms(const rect_source *sources, std::size_t count, core::matrix4f *matrices, core::vector4f *clips, const u32 *indices)
+		{
+#if defined(RFE_SIMD_SSE) || defined(RFE_SIMD_NEON)
+			using namespace core::simd;
+
+			const f32x4 x_row = set(1.f, 0.f, 0.f, 0.f);
+			const f32x4 y_row = set(0.f, 1.f, 0.f, 0.f);
+			const f32x4 z_row = set(0.f, 0.f, 1.f, 0.f);
+			//z and w of the last row
+			const f32x4 w_row = set(0.f, 1.f, 0.f, 0.f);
+			const f32x4 flip_y = set(1.f, -1.f, 0.f, 0.f);
+
+			rect_kernel(sources, count, indices, [&](std::size_t index, f32x4 scale, f32x4 translate, f32x4 clip)
+			{
+				float *matrix = &matrices[index][0][0];
+
+				core::simd::store(matrix, mul(scale, x_row));
+				core::simd::store(matrix + 4, mul(scale, y_row));
+				core::simd::store(matrix + 8, z_row);
+				core::simd::store(matrix + 12, low_halves(mul(translate, flip_y), w_row));
+				core::simd::store(&clips[index][0], clip);
+			});
+#else
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				std::size_t index = indices ? indices[i] : i;
+				rect_transform(sources[i], matrices[index], clips[index]);
+			}
+#endif
+		}
+
+		void rect_transforms(const rect_source *sources, std::size_t count, transform2f *transforms, core::vector4f *clips, const u32 *indices)
+		{
+#if defined(RFE_SIMD_SSE) || defined(RFE_SIMD_NEON)
+			using namespace core::simd;
+
+			const f32x4 flip_y = set(1.f, -1.f, 0.f, 0.f);
+
+			rect_kernel(sources, count, indices, [&](std::size_t index, f32x4 scale, f32x4 translate, f32x4 clip)
+			{
+				core::simd::store((float*)&transforms[index], low_halves(scale, mul(translate, flip_y)));
+				core::simd::store(&clips[index][0], clip);
+			});
+#else
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				std::size_t index = indices ? indices[i] : i;
+				rect_transform(sources[i], transforms[index], clips[index]);
+			}
+#endif
+		}
+	}
 }
\ No newline at end of file
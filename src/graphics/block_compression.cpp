@@ -0,0 +1,1388 @@
+#include <rfe/graphics/block_compression.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace rfe
+{
+	namespace graphics
+	{
+		static u8 clamp_u8(int value)
+		{
+			return (u8)std::min(std::max(value, 0), 255);
+		}
+
+		static int squared_distance(const u8 *lhs, const u8 *rhs, int channels)
+		{
+			int result = 0;
+
+			for (int i = 0; i < channels; ++i)
+			{
+				int difference = int(lhs[i]) - int(rhs[i]);
+				result += difference * difference;
+			}
+
+			return result;
+		}
+
+		//principal axis of the pixels through their mean, endpoints are the outermost projections
+		static void fit_line(const u8 *rgba, int channels, const bool *used, float *first, float *second)
+		{
+			float mean[4] = {};
+			int count = 0;
+
+			for (int i = 0; i < 16; ++i)
+			{
+				if (!used || used[i])
+				{
+					for (int c = 0; c < channels; ++c)
+					{
+						mean[c] += rgba[i * 4 + c];
+					}
+
+					++count;
+				}
+			}
+
+			for (int c = 0; c < channels; ++c)
+			{
+				mean[c] /= std::max(count, 1);
+			}
+
+			float covariance[4][4] = {};
+
+			for (int i = 0; i < 16; ++i)
+			{
+				if (used && !used[i])
+				{
+					continue;
+				}
+
+				for (int a = 0; a < channels; ++a)
+				{
+					for (int b = 0; b < channels; ++b)
+					{
+						covariance[a][b] += (rgba[i * 4 + a] - mean[a]) * (rgba[i * 4 + b] - mean[b]);
+					}
+				}
+			}
+
+			float axis[4] = { 1.f, 1.f, 1.f, 1.f };
+
+			for (int iteration = 0; iteration < 8; ++iteration)
+			{
+				float next[4] = {};
+				float length = 0.f;
+
+				for (int a = 0; a < channels; ++a)
+				{
+					for (int b = 0; b < channels; ++b)
+					{
+						next[a] += covariance[a][b] * axis[b];
+					}
+
+					length = std::max(length, std::abs(next[a]));
+				}
+
+				if (length <= 0.f)
+				{
+					break;
+				}
+
+				for (int a = 0; a < channels; ++a)
+				{
+					axis[a] = next[a] / length;
+				}
+			}
+
+			float low = 0.f;
+			float high = 0.f;
+			float axis_length = 0.f;
+
+			for (int c = 0; c < channels; ++c)
+			{
+				axis_length += axis[c] * axis[c];
+			}
+
+			if (axis_length > 0.f)
+			{
+				low = 1e9f;
+				high = -1e9f;
+
+				for (int i = 0; i < 16; ++i)
+				{
+					if (used && !used[i])
+					{
+						continue;
+					}
+
+					float t = 0.f;
+
+					for (int c = 0; c < channels; ++c)
+					{
+						t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+					}
+
+					low = std::min(low, t / axis_length);
+					high = std::max(high, t / axis_length);
+				}
+			}
+
+			for (int c = 0; c < channels; ++c)
+			{
+				first[c] = std::min(std::max(mean[c] + axis[c] * low, 0.f), 255.f);
+				second[c] = std::min(std::max(mean[c] + axis[c] * high, 0.f), 255.f);
+			}
+		}
+
+		//bc1 and bc3
+
+		static u16 pack565(const float *rgb)
+		{
+			return u16(int(rgb[0] * 31.f / 255.f + 0.5f) << 11 | int(rgb[1] * 63.f / 255.f + 0.5f) << 5 | int(rgb[2] * 31.f / 255.f + 0.5f));
+		}
+
+		static void unpack565(u16 color, u8 *rgba)
+		{
+			int r = color >> 11 & 31;
+			int g = color >> 5 & 63;
+			int b = color & 31;
+
+			rgba[0] = u8(r << 3 | r >> 2);
+			rgba[1] = u8(g << 2 | g >> 4);
+			rgba[2] = u8(b << 3 | b >> 2);
+			rgba[3] = 255;
+		}
+
+		static void bc1_palette(u16 color0, u16 color1, bool four_colors, u8 (*palette)[4])
+		{
+			unpack565(color0, palette[0]);
+			unpack565(color1, palette[1]);
+
+			for (int c = 0; c < 3; ++c)
+			{
+				if (four_colors)
+				{
+					palette[2][c] = u8((2 * palette[0][c] + palette[1][c]) / 3);
+					palette[3][c] = u8((palette[0][c] + 2 * palette[1][c]) / 3);
+				}
+				else
+				{
+					palette[2][c] = u8((palette[0][c] + palette[1][c]) / 2);
+					palette[3][c] = 0;
+				}
+			}
+
+			palette[2][3] = 255;
+			palette[3][3] = four_colors ? 255 : 0;
+		}
+
+		static void decode_bc1_colors(const u8 *block, u8 *rgba, bool allow_transparent)
+		{
+			u16 color0 = u16(block[0] | block[1] << 8);
+			u16 color1 = u16(block[2] | block[3] << 8);
+			u32 indices = u32(block[4] | block[5] << 8 | block[6] << 16 | block[7] << 24);
+			u8 palette[4][4];
+
+			bc1_palette(color0, color1, color0 > color1 || !allow_transparent, palette);
+
+			for (int i = 0; i < 16; ++i)
+			{
+				std::memcpy(rgba + i * 4, palette[indices >> (i * 2) & 3], 4);
+			}
+		}
+
+		static void encode_bc1_colors(const u8 *rgba, u8 *block, bool allow_transparent)
+		{
+			bool used[16];
+			bool transparent = false;
+
+			for (int i = 0; i < 16; ++i)
+			{
+				used[i] = !allow_transparent || rgba[i * 4 + 3] >= 128;
+				transparent |= !used[i];
+			}
+
+			if (transparent && std::none_of(used, used + 16, [](bool value) { return value; }))
+			{
+				std::memset(block, 0, 4);
+				std::memset(block + 4, 0xff, 4);
+				return;
+			}
+
+			float first[3];
+			float second[3];
+			fit_line(rgba, 3, used, first, second);
+
+			u16 color0 = pack565(second);
+			u16 color1 = pack565(first);
+
+			//four colors need color0 > color1, three colors and transparent black the opposite
+			if (transparent ? color0 > color1 : color0 < color1)
+			{
+				std::swap(color0, color1);
+			}
+
+			u8 palette[4][4];
+			bc1_palette(color0, color1, color0 > color1, palette);
+			u32 indices = 0;
+
+			for (int i = 0; i < 16; ++i)
+			{
+				int best = 3;
+
+				if (used[i])
+				{
+					int best_distance = 1 << 30;
+					int candidates = transparent || color0 == color1 ? 3 : 4;
+
+					for (int candidate = 0; candidate < candidates; ++candidate)
+					{
+						int distance = squared_distance(rgba + i * 4, palette[candidate], 3);
+
+						if (distance < best_distance)
+						{
+							best_distance = distance;
+							best = candidate;
+						}
+					}
+				}
+
+				indices |= u32(best) << (i * 2);
+			}
+
+			block[0] = u8(color0);
+			block[1] = u8(color0 >> 8);
+			block[2] = u8(color1);
+			block[3] = u8(color1 >> 8);
+			block[4] = u8(indices);
+			block[5] = u8(indices >> 8);
+			block[6] = u8(indices >> 16);
+			block[7] = u8(indices >> 24);
+		}
+
+		static void bc3_alpha_palette(int alpha0, int alpha1, int *palette)
+		{
+			palette[0] = alpha0;
+			palette[1] = alpha1;
+
+			if (alpha0 > alpha1)
+			{
+				for (int i = 2; i < 8; ++i)
+				{
+					palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+				}
+			}
+			else
+			{
+				for (int i = 2; i < 6; ++i)
+				{
+					palette[i] = ((6 - i) * alpha0 + (i - 1) * alpha1) / 5;
+				}
+
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+		}
+
+		static void decode_bc3_alpha(const u8 *block, u8 *rgba)
+		{
+			int palette[8];
+			bc3_alpha_palette(block[0], block[1], palette);
+
+			u64 indices = 0;
+
+			for (int i = 0; i < 6; ++i)
+			{
+				indices |= u64(block[2 + i]) << (i * 8);
+			}
+
+			for (int i = 0; i < 16; ++i)
+			{
+				rgba[i * 4 + 3] = u8(palette[indices >> (i * 3) & 7]);
+			}
+		}
+
+		static void encode_bc3_alpha(const u8 *rgba, u8 *block)
+		{
+			int low = 255;
+			int high = 0;
+
+			for (int i = 0; i < 16; ++i)
+			{
+				low = std::min<int>(low, rgba[i * 4 + 3]);
+				high = std::max<int>(high, rgba[i * 4 + 3]);
+			}
+
+			int palette[8];
+			bc3_alpha_palette(high, low, palette);
+			u64 indices = 0;
+
+			for (int i = 0; high > low && i < 16; ++i)
+			{
+				int best = 0;
+
+				for (int candidate = 1; candidate < 8; ++candidate)
+				{
+					if (std::abs(palette[candidate] - rgba[i * 4 + 3]) < std::abs(palette[best] - rgba[i * 4 + 3]))
+					{
+						best = candidate;
+					}
+				}
+
+				indices |= u64(best) << (i * 3);
+			}
+
+			block[0] = u8(high);
+			block[1] = u8(low);
+
+			for (int i = 0; i < 6; ++i)
+			{
+				block[2 + i] = u8(indices >> (i * 8));
+			}
+		}
+
+		//bc7
+
+		static const u16 bc7_partitions2[64] =
+		{
+			0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+			0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+			0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+			0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+			0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+			0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+			0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+			0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22
+		};
+
+		//2 bits of subset per pixel
+		static const u32 bc7_partitions3[64] =
+		{
+			0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+			0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+			0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+			0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+			0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+			0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+			0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+			0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254
+		};
+
+		static const u8 bc7_anchors2[64] =
+		{
+			15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+			15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+			15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+			6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+		};
+
+		static const u8 bc7_anchors3_second[64] =
+		{
+			3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+			3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+			8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+			3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3
+		};
+
+		static const u8 bc7_anchors3_third[64] =
+		{
+			15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+			15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+			15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+			15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8
+		};
+
+		static const u8 bc7_weights2[4] = { 0, 21, 43, 64 };
+		static const u8 bc7_weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+		static const u8 bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		struct bc7_mode_t
+		{
+			int subsets;
+			int partition_bits;
+			int rotation_bits;
+			int index_selection_bits;
+			int color_bits;
+			int alpha_bits;
+			int endpoint_pbits;
+			int shared_pbits;
+			int index_bits;
+			int secondary_index_bits;
+		};
+
+		static const bc7_mode_t bc7_modes[8] =
+		{
+			{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+			{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+			{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+			{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+			{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+			{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+			{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+			{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+		};
+
+		static const u8* bc7_weights(int bits)
+		{
+			return bits == 2 ? bc7_weights2 : bits == 3 ? bc7_weights3 : bc7_weights4;
+		}
+
+		static int bc7_subset(int subsets, int partition, int pixel)
+		{
+			switch (subsets)
+			{
+			case 2: return bc7_partitions2[partition] >> pixel & 1;
+			case 3: return bc7_partitions3[partition] >> (pixel * 2) & 3;
+			default: return 0;
+			}
+		}
+
+		static bool bc7_anchor(int subsets, int partition, int pixel)
+		{
+			switch (subsets)
+			{
+			case 2: return pixel == 0 || pixel == bc7_anchors2[partition];
+			case 3: return pixel == 0 || pixel == bc7_anchors3_second[partition] || pixel == bc7_anchors3_third[partition];
+			default: return pixel == 0;
+			}
+		}
+
+		//bits from the lowest of the first byte up
+		class bit_reader
+		{
+			const u8 *m_data;
+			int m_position = 0;
+
+		public:
+			bit_reader(const u8 *data) : m_data(data)
+			{
+			}
+
+			int read(int count)
+			{
+				int result = 0;
+
+				for (int i = 0; i < count; ++i, ++m_position)
+				{
+					result |= (m_data[m_position >> 3] >> (m_position & 7) & 1) << i;
+				}
+
+				return result;
+			}
+		};
+
+		class bit_writer
+		{
+			u8 *m_data;
+			int m_position = 0;
+
+		public:
+			bit_writer(u8 *data, std::size_t size) : m_data(data)
+			{
+				std::memset(data, 0, size);
+			}
+
+			void write(int value, int count)
+			{
+				for (int i = 0; i < count; ++i, ++m_position)
+				{
+					m_data[m_position >> 3] |= u8((value >> i & 1) << (m_position & 7));
+				}
+			}
+		};
+
+		static void decode_bc7(const u8 *block, u8 *rgba)
+		{
+			int mode_index = 0;
+
+			while (mode_index < 8 && !(block[0] >> mode_index & 1))
+			{
+				++mode_index;
+			}
+
+			//reserved, decoded as transparent black
+			if (mode_index == 8)
+			{
+				std::memset(rgba, 0, 64);
+				return;
+			}
+
+			const bc7_mode_t &mode = bc7_modes[mode_index];
+			bit_reader reader(block);
+			reader.read(mode_index + 1);
+
+			int partition = reader.read(mode.partition_bits);
+			int rotation = reader.read(mode.rotation_bits);
+			int index_selection = reader.read(mode.index_selection_bits);
+
+			int endpoints[6][4];
+
+			for (int c = 0; c < 3; ++c)
+			{
+				for (int e = 0; e < mode.subsets * 2; ++e)
+				{
+					endpoints[e][c] = reader.read(mode.color_bits);
+				}
+			}
+
+			for (int e = 0; e < mode.subsets * 2; ++e)
+			{
+				endpoints[e][3] = mode.alpha_bits ? reader.read(mode.alpha_bits) : 255;
+			}
+
+			int color_bits = mode.color_bits;
+			int alpha_bits = mode.alpha_bits;
+
+			if (mode.endpoint_pbits || mode.shared_pbits)
+			{
+				int pbits[6];
+
+				for (int e = 0; e < mode.subsets * 2; ++e)
+				{
+					pbits[e] = mode.endpoint_pbits ? reader.read(1) : (e & 1 ? pbits[e - 1] : reader.read(1));
+				}
+
+				for (int e = 0; e < mode.subsets * 2; ++e)
+				{
+					for (int c = 0; c < 3; ++c)
+					{
+						endpoints[e][c] = endpoints[e][c] << 1 | pbits[e];
+					}
+
+					if (alpha_bits)
+					{
+						endpoints[e][3] = endpoints[e][3] << 1 | pbits[e];
+					}
+				}
+
+				++color_bits;
+				alpha_bits += alpha_bits ? 1 : 0;
+			}
+
+			for (int e = 0; e < mode.subsets * 2; ++e)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					endpoints[e][c] = endpoints[e][c] << (8 - color_bits);
+					endpoints[e][c] |= endpoints[e][c] >> color_bits;
+				}
+
+				if (alpha_bits)
+				{
+					endpoints[e][3] = endpoints[e][3] << (8 - alpha_bits);
+					endpoints[e][3] |= endpoints[e][3] >> alpha_bits;
+				}
+			}
+
+			int indices[16];
+			int secondary_indices[16];
+
+			for (int i = 0; i < 16; ++i)
+			{
+				indices[i] = reader.read(mode.index_bits - (bc7_anchor(mode.subsets, partition, i) ? 1 : 0));
+			}
+
+			for (int i = 0; mode.secondary_index_bits && i < 16; ++i)
+			{
+				secondary_indices[i] = reader.read(mode.secondary_index_bits - (i == 0 ? 1 : 0));
+			}
+
+			for (int i = 0; i < 16; ++i)
+			{
+				const int *first = endpoints[bc7_subset(mode.subsets, partition, i) * 2];
+				const int *second = first + 4;
+				u8 *pixel = rgba + i * 4;
+
+				int color_weight;
+				int alpha_weight;
+
+				if (mode.secondary_index_bits)
+				{
+					//the index selection bit gives the wider indices to the colors
+					bool swap = index_selection != 0;
+					color_weight = swap ? bc7_weights(mode.secondary_index_bits)[secondary_indices[i]] : bc7_weights(mode.index_bits)[indices[i]];
+					alpha_weight = swap ? bc7_weights(mode.index_bits)[indices[i]] : bc7_weights(mode.secondary_index_bits)[secondary_indices[i]];
+				}
+				else
+				{
+					color_weight = alpha_weight = bc7_weights(mode.index_bits)[indices[i]];
+				}
+
+				for (int c = 0; c < 3; ++c)
+				{
+					pixel[c] = u8(((64 - color_weight) * first[c] + color_weight * second[c] + 32) >> 6);
+				}
+
+				pixel[3] = u8(((64 - alpha_weight) * first[3] + alpha_weight * second[3] + 32) >> 6);
+
+				if (rotation)
+				{
+					std::swap(pixel[3], pixel[rotation - 1]);
+				}
+			}
+		}
+
+		//mode 6 only, one subset of rgba endpoints with 4 bit indices
+		static void encode_bc7(const u8 *rgba, u8 *block)
+		{
+			float fitted[2][4];
+			fit_line(rgba, 4, nullptr, fitted[0], fitted[1]);
+
+			int endpoints[2][4];
+			int pbits[2];
+
+			for (int e = 0; e < 2; ++e)
+			{
+				int best_error = 1 << 30;
+
+				for (int pbit = 0; pbit < 2; ++pbit)
+				{
+					int error = 0;
+					int quantized[4];
+
+					for (int c = 0; c < 4; ++c)
+					{
+						quantized[c] = std::min(std::max(int((fitted[e][c] - pbit) / 2.f + 0.5f), 0), 127);
+						int difference = (quantized[c] << 1 | pbit) - int(fitted[e][c] + 0.5f);
+						error += difference * difference;
+					}
+
+					if (error < best_error)
+					{
+						best_error = error;
+						pbits[e] = pbit;
+						std::copy(quantized, quantized + 4, endpoints[e]);
+					}
+				}
+			}
+
+			u8 palette[16][4];
+
+			for (int i = 0; i < 16; ++i)
+			{
+				for (int c = 0; c < 4; ++c)
+				{
+					int first = endpoints[0][c] << 1 | pbits[0];
+					int second = endpoints[1][c] << 1 | pbits[1];
+					palette[i][c] = u8(((64 - bc7_weights4[i]) * first + bc7_weights4[i] * second + 32) >> 6);
+				}
+			}
+
+			int indices[16];
+
+			for (int i = 0; i < 16; ++i)
+			{
+				int best_distance = 1 << 30;
+
+				for (int candidate = 0; candidate < 16; ++candidate)
+				{
+					int distance = squared_distance(rgba + i * 4, palette[candidate], 4);
+
+					if (distance < best_distance)
+					{
+						best_distance = distance;
+						indices[i] = candidate;
+					}
+				}
+			}
+
+			//the anchor index has no top bit, the endpoints are swapped to clear it
+			if (indices[0] & 8)
+			{
+				std::swap(endpoints[0], endpoints[1]);
+				std::swap(pbits[0], pbits[1]);
+
+				for (int &index : indices)
+				{
+					index = 15 - index;
+				}
+			}
+
+			bit_writer writer(block, 16);
+			writer.write(1 << 6, 7);
+
+			for (int c = 0; c < 4; ++c)
+			{
+				writer.write(endpoints[0][c], 7);
+				writer.write(endpoints[1][c], 7);
+			}
+
+			writer.write(pbits[0], 1);
+			writer.write(pbits[1], 1);
+
+			for (int i = 0; i < 16; ++i)
+			{
+				writer.write(indices[i], i == 0 ? 3 : 4);
+			}
+		}
+
+		//etc2 and eac, blocks are big endian and indexed by column
+
+		static const int etc1_modifiers[8][4] =
+		{
+			{ 2, 8, -2, -8 },
+			{ 5, 17, -5, -17 },
+			{ 9, 29, -9, -29 },
+			{ 13, 42, -13, -42 },
+			{ 18, 60, -18, -60 },
+			{ 24, 80, -24, -80 },
+			{ 33, 106, -33, -106 },
+			{ 47, 183, -47, -183 }
+		};
+
+		static const int etc2_distances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+		static const int eac_modifiers[16][8] =
+		{
+			{ -3, -6, -9, -15, 2, 5, 8, 14 },
+			{ -3, -7, -10, -13, 2, 6, 9, 12 },
+			{ -2, -5, -8, -13, 1, 4, 7, 12 },
+			{ -2, -4, -6, -13, 1, 3, 5, 12 },
+			{ -3, -6, -8, -12, 2, 5, 7, 11 },
+			{ -3, -7, -9, -11, 2, 6, 8, 10 },
+			{ -4, -7, -8, -11, 3, 6, 7, 10 },
+			{ -3, -5, -8, -11, 2, 4, 7, 10 },
+			{ -2, -6, -8, -10, 1, 5, 7, 9 },
+			{ -2, -5, -8, -10, 1, 4, 7, 9 },
+			{ -2, -4, -8, -10, 1, 3, 7, 9 },
+			{ -2, -5, -7, -10, 1, 4, 6, 9 },
+			{ -3, -4, -7, -10, 2, 3, 6, 9 },
+			{ -1, -2, -3, -10, 0, 1, 2, 9 },
+			{ -4, -6, -8, -9, 3, 5, 7, 8 },
+			{ -3, -5, -7, -9, 2, 4, 6, 8 }
+		};
+
+		static u64 read_big_endian(const u8 *data)
+		{
+			u64 result = 0;
+
+			for (int i = 0; i < 8; ++i)
+			{
+				result = result << 8 | data[i];
+			}
+
+			return result;
+		}
+
+		static void write_big_endian(u64 value, u8 *data)
+		{
+			for (int i = 7; i >= 0; --i)
+			{
+				data[i] = u8(value);
+				value >>= 8;
+			}
+		}
+
+		static int expand4(int value)
+		{
+			return value << 4 | value;
+		}
+
+		static int expand5(int value)
+		{
+			return value << 3 | value >> 2;
+		}
+
+		static int sign_extend3(int value)
+		{
+			return value >= 4 ? value - 8 : value;
+		}
+
+		static void decode_etc2_colors(const u8 *block, u8 *rgba)
+		{
+			u64 bits = read_big_endian(block);
+			bool differential = (bits >> 33 & 1) != 0;
+			bool flip = (bits >> 32 & 1) != 0;
+
+			auto pixel_index = [&](int x, int y)
+			{
+				int i = x * 4 + y;
+				return int(bits >> (16 + i) & 1) << 1 | int(bits >> i & 1);
+			};
+
+			auto set = [&](int x, int y, int r, int g, int b)
+			{
+				u8 *pixel = rgba + (y * 4 + x) * 4;
+				pixel[0] = clamp_u8(r);
+				pixel[1] = clamp_u8(g);
+				pixel[2] = clamp_u8(b);
+				pixel[3] = 255;
+			};
+
+			int colors[2][3];
+
+			if (differential)
+			{
+				int base[3] = { int(bits >> 59 & 31), int(bits >> 51 & 31), int(bits >> 43 & 31) };
+				int delta[3] = { sign_extend3(bits >> 56 & 7), sign_extend3(bits >> 48 & 7), sign_extend3(bits >> 40 & 7) };
+
+				if (base[0] + delta[0] < 0 || base[0] + delta[0] > 31)
+				{
+					//t mode, one color and three around the other
+					int first[3] = { expand4(int((bits >> 59 & 3) << 2 | (bits >> 56 & 3))), expand4(int(bits >> 52 & 15)), expand4(int(bits >> 48 & 15)) };
+					int second[3] = { expand4(int(bits >> 44 & 15)), expand4(int(bits >> 40 & 15)), expand4(int(bits >> 36 & 15)) };
+					int distance = etc2_distances[(bits >> 34 & 3) << 1 | (bits >> 32 & 1)];
+					int paint[4][3];
+
+					for (int c = 0; c < 3; ++c)
+					{
+						paint[0][c] = first[c];
+						paint[1][c] = second[c] + distance;
+						paint[2][c] = second[c];
+						paint[3][c] = second[c] - distance;
+					}
+
+					for (int x = 0; x < 4; ++x)
+					{
+						for (int y = 0; y < 4; ++y)
+						{
+							const int *color = paint[pixel_index(x, y)];
+							set(x, y, color[0], color[1], color[2]);
+						}
+					}
+
+					return;
+				}
+
+				if (base[1] + delta[1] < 0 || base[1] + delta[1] > 31)
+				{
+					//h mode, two colors each with two around it
+					int first4[3] = { int(bits >> 59 & 15), int((bits >> 56 & 7) << 1 | (bits >> 52 & 1)), int((bits >> 51 & 1) << 3 | (bits >> 47 & 7)) };
+					int second4[3] = { int(bits >> 43 & 15), int(bits >> 39 & 15), int(bits >> 35 & 15) };
+					int order = (first4[0] << 8 | first4[1] << 4 | first4[2]) >= (second4[0] << 8 | second4[1] << 4 | second4[2]) ? 1 : 0;
+					int distance = etc2_distances[(bits >> 34 & 1) << 2 | (bits >> 32 & 1) << 1 | order];
+					int paint[4][3];
+
+					for (int c = 0; c < 3; ++c)
+					{
+						paint[0][c] = expand4(first4[c]) + distance;
+						paint[1][c] = expand4(first4[c]) - distance;
+						paint[2][c] = expand4(second4[c]) + distance;
+						paint[3][c] = expand4(second4[c]) - distance;
+					}
+
+					for (int x = 0; x < 4; ++x)
+					{
+						for (int y = 0; y < 4; ++y)
+						{
+							const int *color = paint[pixel_index(x, y)];
+							set(x, y, color[0], color[1], color[2]);
+						}
+					}
+
+					return;
+				}
+
+				if (base[2] + delta[2] < 0 || base[2] + delta[2] > 31)
+				{
+					//planar, a gradient between three colors
+					int origin[3] = { int(bits >> 57 & 63), int((bits >> 56 & 1) << 6 | (bits >> 49 & 63)), int((bits >> 48 & 1) << 5 | (bits >> 43 & 3) << 3 | (bits >> 39 & 7)) };
+					int horizontal[3] = { int((bits >> 34 & 31) << 1 | (bits >> 32 & 1)), int(bits >> 25 & 127), int(bits >> 19 & 63) };
+					int vertical[3] = { int(bits >> 13 & 63), int(bits >> 6 & 127), int(bits & 63) };
+					const int widths[3] = { 6, 7, 6 };
+
+					for (int c = 0; c < 3; ++c)
+					{
+						int width = widths[c];
+						origin[c] = origin[c] << (8 - width) | origin[c] >> (2 * width - 8);
+						horizontal[c] = horizontal[c] << (8 - width) | horizontal[c] >> (2 * width - 8);
+						vertical[c] = vertical[c] << (8 - width) | vertical[c] >> (2 * width - 8);
+					}
+
+					for (int x = 0; x < 4; ++x)
+					{
+						for (int y = 0; y < 4; ++y)
+						{
+							int color[3];
+
+							for (int c = 0; c < 3; ++c)
+							{
+								color[c] = (x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+							}
+
+							set(x, y, color[0], color[1], color[2]);
+						}
+					}
+
+					return;
+				}
+
+				for (int c = 0; c < 3; ++c)
+				{
+					colors[0][c] = expand5(base[c]);
+					colors[1][c] = expand5(base[c] + delta[c]);
+				}
+			}
+			else
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					colors[0][c] = expand4(int(bits >> (60 - c * 8) & 15));
+					colors[1][c] = expand4(int(bits >> (56 - c * 8) & 15));
+				}
+			}
+
+			int tables[2] = { int(bits >> 37 & 7), int(bits >> 34 & 7) };
+
+			for (int x = 0; x < 4; ++x)
+			{
+				for (int y = 0; y < 4; ++y)
+				{
+					int subblock = flip ? (y >= 2) : (x >= 2);
+					int modifier = etc1_modifiers[tables[subblock]][pixel_index(x, y)];
+					const int *color = colors[subblock];
+
+					set(x, y, color[0] + modifier, color[1] + modifier, color[2] + modifier);
+				}
+			}
+		}
+
+		//individual and differential modes only, which every etc decoder reads
+		static void encode_etc2_colors(const u8 *rgba, u8 *block)
+		{
+			u64 best_bits = 0;
+			long best_error = -1;
+
+			for (int flip = 0; flip < 2; ++flip)
+			{
+				auto subblock_of = [&](int x, int y) { return flip ? (y >= 2) : (x >= 2); };
+
+				float averages[2][3] = {};
+
+				for (int y = 0; y < 4; ++y)
+				{
+					for (int x = 0; x < 4; ++x)
+					{
+						for (int c = 0; c < 3; ++c)
+						{
+							averages[subblock_of(x, y)][c] += rgba[(y * 4 + x) * 4 + c] / 8.f;
+						}
+					}
+				}
+
+				for (int differential = 0; differential < 2; ++differential)
+				{
+					int quantized[2][3];
+					int colors[2][3];
+					bool representable = true;
+
+					for (int s = 0; s < 2; ++s)
+					{
+						for (int c = 0; c < 3; ++c)
+						{
+							if (differential)
+							{
+								quantized[s][c] = std::min(int(averages[s][c] * 31.f / 255.f + 0.5f), 31);
+							}
+							else
+							{
+								quantized[s][c] = std::min(int(averages[s][c] * 15.f / 255.f + 0.5f), 15);
+								colors[s][c] = expand4(quantized[s][c]);
+							}
+						}
+					}
+
+					if (differential)
+					{
+						for (int c = 0; c < 3; ++c)
+						{
+							int delta = quantized[1][c] - quantized[0][c];
+
+							if (delta < -4 || delta > 3)
+							{
+								representable = false;
+							}
+
+							colors[0][c] = expand5(quantized[0][c]);
+							colors[1][c] = expand5(quantized[1][c]);
+						}
+					}
+
+					if (!representable)
+					{
+						continue;
+					}
+
+					long error = 0;
+					int tables[2];
+					u32 indices = 0;
+
+					for (int s = 0; s < 2; ++s)
+					{
+						long best_table_error = -1;
+						u32 best_table_indices = 0;
+
+						for (int table = 0; table < 8; ++table)
+						{
+							long table_error = 0;
+							u32 table_indices = 0;
+
+							for (int x = 0; x < 4; ++x)
+							{
+								for (int y = 0; y < 4; ++y)
+								{
+									if (subblock_of(x, y) != s)
+									{
+										continue;
+									}
+
+									const u8 *pixel = rgba + (y * 4 + x) * 4;
+									int best_index = 0;
+									int best_distance = 1 << 30;
+
+									for (int index = 0; index < 4; ++index)
+									{
+										int modifier = etc1_modifiers[table][index];
+										u8 candidate[3] = { clamp_u8(colors[s][0] + modifier), clamp_u8(colors[s][1] + modifier), clamp_u8(colors[s][2] + modifier) };
+										int distance = squared_distance(pixel, candidate, 3);
+
+										if (distance < best_distance)
+										{
+											best_distance = distance;
+											best_index = index;
+										}
+									}
+
+									int i = x * 4 + y;
+									table_error += best_distance;
+									table_indices |= u32(best_index >> 1) << (16 + i) | u32(best_index & 1) << i;
+								}
+							}
+
+							if (best_table_error < 0 || table_error < best_table_error)
+							{
+								best_table_error = table_error;
+								best_table_indices = table_indices;
+								tables[s] = table;
+							}
+						}
+
+						error += best_table_error;
+						indices |= best_table_indices;
+					}
+
+					if (best_error >= 0 && error >= best_error)
+					{
+						continue;
+					}
+
+					u64 bits = 0;
+
+					for (int c = 0; c < 3; ++c)
+					{
+						if (differential)
+						{
+							bits |= u64(quantized[0][c]) << (59 - c * 8);
+							bits |= u64((quantized[1][c] - quantized[0][c]) & 7) << (56 - c * 8);
+						}
+						else
+						{
+							bits |= u64(quantized[0][c]) << (60 - c * 8);
+							bits |= u64(quantized[1][c]) << (56 - c * 8);
+						}
+					}
+
+					bits |= u64(tables[0]) << 37 | u64(tables[1]) << 34 | u64(differential) << 33 | u64(flip) << 32 | indices;
+
+					best_error = error;
+					best_bits = bits;
+				}
+			}
+
+			write_big_endian(best_bits, block);
+		}
+
+		static void decode_eac_alpha(const u8 *block, u8 *rgba)
+		{
+			int base = block[0];
+			int multiplier = block[1] >> 4;
+			const int *modifiers = eac_modifiers[block[1] & 15];
+			u64 indices = 0;
+
+			for (int i = 2; i < 8; ++i)
+			{
+				indices = indices << 8 | block[i];
+			}
+
+			for (int x = 0; x < 4; ++x)
+			{
+				for (int y = 0; y < 4; ++y)
+				{
+					int index = int(indices >> (45 - (x * 4 + y) * 3) & 7);
+					rgba[(y * 4 + x) * 4 + 3] = clamp_u8(base + modifiers[index] * multiplier);
+				}
+			}
+		}
+
+		static void encode_eac_alpha(const u8 *rgba, u8 *block)
+		{
+			int low = 255;
+			int high = 0;
+
+			for (int i = 0; i < 16; ++i)
+			{
+				low = std::min<int>(low, rgba[i * 4 + 3]);
+				high = std::max<int>(high, rgba[i * 4 + 3]);
+			}
+
+			//a zero multiplier repeats the base for every pixel
+			int best_base = low;
+			int best_table = 0;
+			int best_multiplier = 0;
+			long best_error = low == high ? 0 : -1;
+
+			for (int table = 0; best_error != 0 && table < 16; ++table)
+			{
+				const int *modifiers = eac_modifiers[table];
+
+				for (int multiplier = 1; multiplier < 16; ++multiplier)
+				{
+					int base = clamp_u8((low + high) / 2 - (modifiers[3] + modifiers[7]) * multiplier / 2);
+					long error = 0;
+
+					for (int i = 0; i < 16; ++i)
+					{
+						int best_distance = 1 << 30;
+
+						for (int index = 0; index < 8; ++index)
+						{
+							int difference = clamp_u8(base + modifiers[index] * multiplier) - rgba[i * 4 + 3];
+							best_distance = std::min(best_distance, difference * difference);
+						}
+
+						error += best_distance;
+					}
+
+					if (best_error < 0 || error < best_error)
+					{
+						best_error = error;
+						best_base = base;
+						best_table = table;
+						best_multiplier = multiplier;
+					}
+				}
+			}
+
+			u64 indices = 0;
+
+			for (int x = 0; x < 4; ++x)
+			{
+				for (int y = 0; y < 4; ++y)
+				{
+					int alpha = rgba[(y * 4 + x) * 4 + 3];
+					int best_index = 0;
+					int best_distance = 1 << 30;
+
+					for (int index = 0; index < 8; ++index)
+					{
+						int difference = clamp_u8(best_base + eac_modifiers[best_table][index] * best_multiplier) - alpha;
+
+						if (difference * difference < best_distance)
+						{
+							best_distance = difference * difference;
+							best_index = index;
+						}
+					}
+
+					indices |= u64(best_index) << (45 - (x * 4 + y) * 3);
+				}
+			}
+
+			block[0] = u8(best_base);
+			block[1] = u8(best_multiplier << 4 | best_table);
+
+			for (int i = 7; i >= 2; --i)
+			{
+				block[i] = u8(indices);
+				indices >>= 8;
+			}
+		}
+
+		void encode_block(pixels_type type, const u8 *rgba, u8 *block)
+		{
+			switch (type)
+			{
+			case pixels_type::bc1: encode_bc1_colors(rgba, block, true); break;
+			case pixels_type::bc3: encode_bc3_alpha(rgba, block); encode_bc1_colors(rgba, block + 8, false); break;
+			case pixels_type::bc7: encode_bc7(rgba, block); break;
+			case pixels_type::etc2_rgb8: encode_etc2_colors(rgba, block); break;
+			case pixels_type::etc2_rgba8: encode_eac_alpha(rgba, block); encode_etc2_colors(rgba, block + 8); break;
+			default: throw std::runtime_error("block_compression: not a compressed pixels type");
+			}
+		}
+
+		void decode_block(pixels_type type, const u8 *block, u8 *rgba)
+		{
+			switch (type)
+			{
+			case pixels_type::bc1: decode_bc1_colors(block, rgba, true); break;
+			case pixels_type::bc3: decode_bc1_colors(block + 8, rgba, false); decode_bc3_alpha(block, rgba); break;
+			case pixels_type::bc7: decode_bc7(block, rgba); break;
+			case pixels_type::etc2_rgb8: decode_etc2_colors(block, rgba); break;
+			case pixels_type::etc2_rgba8: decode_etc2_colors(block + 8, rgba); decode_eac_alpha(block, rgba); break;
+			default: throw std::runtime_error("block_compression: not a compressed pixels type");
+			}
+		}
+
+		//rgba of an uncompressed pixel
+		static void read_pixel(const image &source, const u8 *pixels, size2i size, int x, int y, u8 *rgba)
+		{
+			if (source.type() == pixels_type::rgb8)
+			{
+				std::memcpy(rgba, pixels + (std::size_t(y) * size.width() + x) * 3, 3);
+				rgba[3] = 255;
+			}
+			else
+			{
+				std::memcpy(rgba, pixels + (std::size_t(y) * size.width() + x) * 4, 4);
+			}
+		}
+
+		std::shared_ptr<image> generate_mipmaps(const image &source, int levels)
+		{
+			if (is_compressed(source.type()))
+			{
+				throw std::runtime_error("generate_mipmaps: compressed images have to be decompressed first");
+			}
+
+			//rows are read tight
+			if (!source.contiguous())
+			{
+				return generate_mipmaps(source.copy(), levels);
+			}
+
+			int channels = source.type() == pixels_type::rgb8 ? 3 : 4;
+			levels = levels > 0 ? std::min(levels, image::full_chain(source.size())) : image::full_chain(source.size());
+
+			image layout(nullptr, source.size(), source.type(), levels);
+			auto pixels = std::make_unique<char[]>(layout.bytes());
+			std::memcpy(pixels.get(), source.level(0), pixels_bytes(source.type(), source.size()));
+
+			for (int level = 1; level < levels; ++level)
+			{
+				size2i from_size = layout.level_size(level - 1);
+				size2i to_size = layout.level_size(level);
+				const u8 *from = (const u8*)pixels.get() + layout.level_offset(level - 1);
+				u8 *to = (u8*)pixels.get() + layout.level_offset(level);
+
+				for (int y = 0; y < to_size.height(); ++y)
+				{
+					int y0 = std::min(y * 2, from_size.height() - 1);
+					int y1 = std::min(y * 2 + 1, from_size.height() - 1);
+
+					for (int x = 0; x < to_size.width(); ++x)
+					{
+						int x0 = std::min(x * 2, from_size.width() - 1);
+						int x1 = std::min(x * 2 + 1, from_size.width() - 1);
+
+						for (int c = 0; c < channels; ++c)
+						{
+							int sum = from[(std::size_t(y0) * from_size.width() + x0) * channels + c] + from[(std::size_t(y0) * from_size.width() + x1) * channels + c] +
+								from[(std::size_t(y1) * from_size.width() + x0) * channels + c] + from[(std::size_t(y1) * from_size.width() + x1) * channels + c];
+
+							to[(std::size_t(y) * to_size.width() + x) * channels + c] = u8((sum + 2) / 4);
+						}
+					}
+				}
+			}
+
+			return std::make_shared<image>(std::move(pixels), source.size(), source.type(), levels, source.origin());
+		}
+
+		std::shared_ptr<image> compress(const image &source, pixels_type type)
+		{
+			if (is_compressed(source.type()) || !is_compressed(type))
+			{
+				throw std::runtime_error("compress: expected an rgba8 or rgb8 image and a compressed type");
+			}
+
+			if (!source.contiguous())
+			{
+				return compress(source.copy(), type);
+			}
+
+			image layout(nullptr, source.size(), type, source.levels());
+			auto blocks = std::make_unique<char[]>(layout.bytes());
+
+			for (int level = 0; level < source.levels(); ++level)
+			{
+				size2i size = source.level_size(level);
+				const u8 *pixels = (const u8*)source.level(level);
+				u8 *block = (u8*)blocks.get() + layout.level_offset(level);
+
+				for (int block_y = 0; block_y < size.height(); block_y += 4)
+				{
+					for (int block_x = 0; block_x < size.width(); block_x += 4)
+					{
+						u8 rgba[64];
+
+						for (int y = 0; y < 4; ++y)
+						{
+							for (int x = 0; x < 4; ++x)
+							{
+								read_pixel(source, pixels, size, std::min(block_x + x, size.width() - 1), std::min(block_y + y, size.height() - 1), rgba + (y * 4 + x) * 4);
+							}
+						}
+
+						encode_block(type, rgba, block);
+						block += block_bytes(type);
+					}
+				}
+			}
+
+			//blocks keep the row order of the pixels
+			return std::make_shared<image>(std::move(blocks), source.size(), type, source.levels(), source.origin());
+		}
+
+		std::shared_ptr<image> decompress(const image &source)
+		{
+			if (!source.contiguous())
+			{
+				return decompress(source.copy());
+			}
+
+			image layout(nullptr, source.size(), pixels_type::rgba8, source.levels());
+			auto pixels = std::make_unique<char[]>(layout.bytes());
+
+			for (int level = 0; level < source.levels(); ++level)
+			{
+				size2i size = source.level_size(level);
+				const u8 *from = (const u8*)source.level(level);
+				u8 *to = (u8*)pixels.get() + layout.level_offset(level);
+
+				if (!is_compressed(source.type()))
+				{
+					for (int y = 0; y < size.height(); ++y)
+					{
+						for (int x = 0; x < size.width(); ++x)
+						{
+							read_pixel(source, from, size, x, y, to + (std::size_t(y) * size.width() + x) * 4);
+						}
+					}
+
+					continue;
+				}
+
+				for (int block_y = 0; block_y < size.height(); block_y += 4)
+				{
+					for (int block_x = 0; block_x < size.width(); block_x += 4)
+					{
+						u8 rgba[64];
+						decode_block(source.type(), from, rgba);
+						from += block_bytes(source.type());
+
+						for (int y = 0; y < 4 && block_y + y < size.height(); ++y)
+						{
+							int width = std::min(4, size.width() - block_x);
+							std::memcpy(to + (std::size_t(block_y + y) * size.width() + block_x) * 4, rgba + y * 16, std::size_t(width) * 4);
+						}
+					}
+				}
+			}
+
+			return std::make_shared<image>(std::move(pixels), source.size(), pixels_type::rgba8, source.levels(), source.origin());
+		}
+	}
+}
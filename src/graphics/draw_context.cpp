@@ -1,5 +1,8 @@
 #include <rfe/graphics/draw_context.h>
+#include <rfe/core/mapped_file.h>
 #include <chrono>
+#include <mutex>
+#include <unordered_map>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -13,6 +16,50 @@ namespace rfe
 	{
 		FT_Library ft_lib;
 
+		//file of a face, mapped once and shared by the handles of every thread
+		struct face_source
+		{
+			std::string path;
+			int index;
+			mapped_file file;
+		};
+
+		static std::mutex face_sources_mtx;
+		static std::unordered_map<void*, std::shared_ptr<face_source>> face_sources;
+
+		//freetype objects are not shared between threads, each one opens the faces it uses
+		struct thread_faces
+		{
+			FT_Library library = nullptr;
+			std::unordered_map<void*, FT_Face> faces;
+
+			~thread_faces()
+			{
+				for (auto &entry : faces)
+				{
+					if (entry.second != entry.first)
+					{
+						FT_Done_Face(entry.second);
+					}
+				}
+
+				if (library)
+				{
+					FT_Done_FreeType(library);
+				}
+			}
+		};
+
+		static thread_local thread_faces this_thread_faces;
+
+		static std::shared_ptr<face_source> find_source(void *ft_face)
+		{
+			std::lock_guard<std::mutex> lock(face_sources_mtx);
+			auto found = face_sources.find(ft_face);
+
+			return found == face_sources.end() ? nullptr : found->second;
+		}
+
 		void init()
 		{
 			if (FT_Init_FreeType(&ft_lib))
@@ -21,24 +68,64 @@ namespace rfe
 			}
 		}
 
+		void *face::native() const
+		{
+			auto &local = this_thread_faces;
+			auto found = local.faces.find(ft_face);
+
+			if (found != local.faces.end())
+			{
+				return found->second;
+			}
+
+			//faces not made by new_face have no source and stay shared
+			FT_Face result = (FT_Face)ft_face;
+
+			if (auto source = find_source(ft_face))
+			{
+				FT_Face own_face;
+
+				if ((local.library || !FT_Init_FreeType(&local.library)) &&
+					!FT_New_Memory_Face(local.library, source->file.data(), (FT_Long)source->file.size(), source->index, &own_face))
+				{
+					result = own_face;
+				}
+			}
+
+			local.faces.emplace(ft_face, result);
+			return result;
+		}
+
 		face& face::set_pixel_sizes(int pixel_height, int pixel_width)
 		{
-			FT_Set_Pixel_Sizes((FT_Face)ft_face, pixel_width, pixel_height);
+			FT_Set_Pixel_Sizes((FT_Face)native(), pixel_width, pixel_height);
 
 			return *this;
 		}
 
-		void face::load_char(char c, load_bits load_bits_) const
+		std::string face::file_path() const
+		{
+			auto source = find_source(ft_face);
+
+			return source ? source->path : std::string{};
+		}
+
+		int face::pixel_size() const
+		{
+			return ((FT_Face)native())->size->metrics.y_ppem;
+		}
+
+		void face::load_char(u32 codepoint, load_bits load_bits_) const
 		{
-			if (FT_Load_Char((FT_Face)ft_face, c, (int)load_bits_))
+			if (FT_Load_Char((FT_Face)native(), codepoint, (int)load_bits_))
 			{
 				throw;
 			}
 		}
 
-		bool face::load_char(std::nothrow_t, char c, load_bits load_bits_) const noexcept
+		bool face::load_char(std::nothrow_t, u32 codepoint, load_bits load_bits_) const noexcept
 		{
-			if (FT_Load_Char((FT_Face)ft_face, c, (int)load_bits_))
+			if (FT_Load_Char((FT_Face)native(), codepoint, (int)load_bits_))
 			{
 				return false;
 			}
@@ -46,38 +133,105 @@ namespace rfe
 			return true;
 		}
 
+		u32 decode_utf8(const std::string &text, std::size_t &position)
+		{
+			const u32 replacement = 0xfffd;
+			u8 lead = (u8)text[position++];
+
+			if (lead < 0x80)
+			{
+				return lead;
+			}
+
+			int length;
+			u32 result;
+
+			if ((lead & 0xe0) == 0xc0)
+			{
+				length = 1;
+				result = lead & 0x1f;
+			}
+			else if ((lead & 0xf0) == 0xe0)
+			{
+				length = 2;
+				result = lead & 0x0f;
+			}
+			else if ((lead & 0xf8) == 0xf0)
+			{
+				length = 3;
+				result = lead & 0x07;
+			}
+			else
+			{
+				return replacement;
+			}
+
+			for (int i = 0; i < length; ++i)
+			{
+				if (position >= text.size() || ((u8)text[position] & 0xc0) != 0x80)
+				{
+					return replacement;
+				}
+
+				result = (result << 6) | ((u8)text[position++] & 0x3f);
+			}
+
+			static const u32 min_value[] = { 0, 0x80, 0x800, 0x10000 };
+
+			if (result < min_value[length] || result > 0x10ffff || (result >= 0xd800 && result <= 0xdfff))
+			{
+				return replacement;
+			}
+
+			return result;
+		}
+
 		face new_face(const std::string &file_path, int face_index)
 		{
+			auto source = std::make_shared<face_source>();
+			source->path = file_path;
+			source->index = face_index;
+
 			FT_Face result;
-			if (FT_New_Face(ft_lib, file_path.c_str(), face_index, &result))
+			if (!source->file.open(file_path) ||
+				FT_New_Memory_Face(ft_lib, source->file.data(), (FT_Long)source->file.size(), face_index, &result))
 			{
 				throw;
 			}
 
+			{
+				std::lock_guard<std::mutex> lock(face_sources_mtx);
+				face_sources[result] = source;
+			}
+
 			return{ result };
 		}
 	}
 
 	namespace graphics
 	{
+		void draw_context::attach(std::shared_ptr<void> parent, std::shared_ptr<drawable_base> drawable_)
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_mtx);
+			m_drawables.push_back({ parent, drawable_ });
+		}
+
 		void draw_context::detach(std::weak_ptr<drawable_base> detach_drawable)
 		{
-			if (auto detach = detach_drawable.lock())
+			auto detach = detach_drawable.lock();
+
+			if (!detach)
 			{
-				for (auto it = m_drawables.begin(); it != m_drawables.end(); ++it)
+				return;
+			}
+
+			for (auto it = m_drawables.begin(); it != m_drawables.end(); ++it)
+			{
+				if (it->drawable == detach)
 				{
-					if (auto locked = it->lock())
-					{
-						if (locked == detach)
-						{
-							m_drawables.erase(it);
-							return;
-						}
-					}
-					else
-					{
-						it = m_drawables.erase(it);
-					}
+					m_released.push_back(std::move(it->drawable));
+					m_drawables.erase(it);
+					return;
 				}
 			}
 		}
@@ -108,8 +262,37 @@ namespace rfe
 
 		void draw_context::present()
 		{
+			std::vector<std::shared_ptr<drawable_base>> released;
+
+			{
+				std::lock_guard<std::recursive_mutex> lock(m_mtx);
+				released.swap(m_released);
+
+				for (auto it = m_drawables.begin(); it != m_drawables.end();)
+				{
+					if (it->parent.expired())
+					{
+						released.push_back(std::move(it->drawable));
+						it = m_drawables.erase(it);
+					}
+					else
+					{
+						++it;
+					}
+				}
+			}
+
+			//destroyed unlocked, the context is current here
+			released.clear();
+
 			++m_frames;
 
+			if (m_first_frame)
+			{
+				m_first_frame = false;
+				first_frame_time = std::chrono::duration<double, std::milli>(clock::now() - m_create_time).count();
+			}
+
 			auto diff = clock::now() - m_fps_flush_time;
 			if (diff >= 1s)
 			{
@@ -0,0 +1,796 @@
+#include <rfe/graphics/glyph_atlas.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+namespace rfe
+{
+	namespace graphics
+	{
+		skyline_packer::skyline_packer(size2i size)
+		{
+			reset(size);
+		}
+
+		void skyline_packer::reset(size2i size)
+		{
+			m_size = size;
+			m_nodes.clear();
+			m_nodes.push_back({ 0, 0, size.width() });
+		}
+
+		void skyline_packer::grow(size2i size)
+		{
+			if (size.width() > m_size.width())
+			{
+				m_nodes.push_back({ m_size.width(), 0, size.width() - m_size.width() });
+			}
+
+			m_size = size;
+		}
+
+		size2i skyline_packer::size() const
+		{
+			return m_size;
+		}
+
+		int skyline_packer::fit(std::size_t index, size2i size) const
+		{
+			int x = m_nodes[index].x;
+
+			if (x + size.width() > m_size.width())
+			{
+				return -1;
+			}
+
+			int y = 0;
+			int width_left = size.width();
+
+			//the rectangle rests on the highest node it spans
+			for (std::size_t i = index; width_left > 0; ++i)
+			{
+				if (i == m_nodes.size())
+				{
+					return -1;
+				}
+
+				y = std::max(y, m_nodes[i].y);
+
+				if (y + size.height() > m_size.height())
+				{
+					return -1;
+				}
+
+				width_left -= m_nodes[i].width;
+			}
+
+			return y;
+		}
+
+		bool skyline_packer::pack(size2i size, point2i &position)
+		{
+			int best_index = -1;
+			int best_y = 0;
+			int best_width = 0;
+
+			for (std::size_t i = 0; i < m_nodes.size(); ++i)
+			{
+				int y = fit(i, size);
+
+				if (y < 0)
+				{
+					continue;
+				}
+
+				if (best_index < 0 || y + size.height() < best_y + size.height() || (y == best_y && m_nodes[i].width < best_width))
+				{
+					best_index = (int)i;
+					best_y = y;
+					best_width = m_nodes[i].width;
+				}
+			}
+
+			if (best_index < 0)
+			{
+				return false;
+			}
+
+			position = { m_nodes[best_index].x, best_y };
+
+			node new_node{ position.x(), best_y + size.height(), size.width() };
+			m_nodes.insert(m_nodes.begin() + best_index, new_node);
+
+			//trim the nodes now covered by the new one
+			for (std::size_t i = best_index + 1; i < m_nodes.size();)
+			{
+				node &previous = m_nodes[i - 1];
+				int shrink = previous.x + previous.width - m_nodes[i].x;
+
+				if (shrink <= 0)
+				{
+					break;
+				}
+
+				m_nodes[i].x += shrink;
+				m_nodes[i].width -= shrink;
+
+				if (m_nodes[i].width > 0)
+				{
+					break;
+				}
+
+				m_nodes.erase(m_nodes.begin() + i);
+			}
+
+			//merge neighbours of the same height
+			for (std::size_t i = 0; i + 1 < m_nodes.size();)
+			{
+				if (m_nodes[i].y == m_nodes[i + 1].y)
+				{
+					m_nodes[i].width += m_nodes[i + 1].width;
+					m_nodes.erase(m_nodes.begin() + i + 1);
+				}
+				else
+				{
+					++i;
+				}
+			}
+
+			return true;
+		}
+
+		//exact squared euclidean distance transform of one row or column (Felzenszwalb, Huttenlocher)
+		static void distance_transform(const float *f, float *d, int *v, float *z, int n)
+		{
+			const float inf = 1e20f;
+			int k = 0;
+
+			v[0] = 0;
+			z[0] = -inf;
+			z[1] = inf;
+
+			for (int q = 1; q < n; ++q)
+			{
+				float s = ((f[q] + float(q) * q) - (f[v[k]] + float(v[k]) * v[k])) / (2.f * q - 2.f * v[k]);
+
+				//z[0] is -inf, so this stops at the first parabola
+				while (s <= z[k])
+				{
+					--k;
+					s = ((f[q] + float(q) * q) - (f[v[k]] + float(v[k]) * v[k])) / (2.f * q - 2.f * v[k]);
+				}
+
+				++k;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = inf;
+			}
+
+			k = 0;
+
+			for (int q = 0; q < n; ++q)
+			{
+				while (z[k + 1] < q)
+				{
+					++k;
+				}
+
+				d[q] = float(q - v[k]) * (q - v[k]) + f[v[k]];
+			}
+		}
+
+		static void distance_transform(std::vector<float> &grid, size2i size)
+		{
+			int length = std::max(size.width(), size.height());
+			std::vector<float> f(length), d(length), z(length + 1);
+			std::vector<int> v(length);
+
+			for (int x = 0; x < size.width(); ++x)
+			{
+				for (int y = 0; y < size.height(); ++y)
+				{
+					f[y] = grid[std::size_t(y) * size.width() + x];
+				}
+
+				distance_transform(f.data(), d.data(), v.data(), z.data(), size.height());
+
+				for (int y = 0; y < size.height(); ++y)
+				{
+					grid[std::size_t(y) * size.width() + x] = d[y];
+				}
+			}
+
+			for (int y = 0; y < size.height(); ++y)
+			{
+				float *row = grid.data() + std::size_t(y) * size.width();
+				std::copy(row, row + size.width(), f.begin());
+				distance_transform(f.data(), d.data(), v.data(), z.data(), size.width());
+				std::copy(d.begin(), d.begin() + size.width(), row);
+			}
+		}
+
+		//0.5 on the outline, growing inside, covering spread pixels around the glyph
+		static std::vector<u8> signed_distance_field(const u8 *coverage, int pitch, size2i size, int spread, size2i &field_size)
+		{
+			const float inf = 1e20f;
+			field_size = { size.width() + spread * 2, size.height() + spread * 2 };
+
+			std::size_t count = std::size_t(field_size.width()) * field_size.height();
+			std::vector<float> outside(count), inside(count);
+
+			for (int y = 0; y < field_size.height(); ++y)
+			{
+				for (int x = 0; x < field_size.width(); ++x)
+				{
+					int bitmap_x = x - spread;
+					int bitmap_y = y - spread;
+
+					bool is_inside = bitmap_x >= 0 && bitmap_y >= 0 && bitmap_x < size.width() && bitmap_y < size.height() &&
+						coverage[std::ptrdiff_t(bitmap_y) * pitch + bitmap_x] >= 128;
+
+					std::size_t index = std::size_t(y) * field_size.width() + x;
+					outside[index] = is_inside ? 0.f : inf;
+					inside[index] = is_inside ? inf : 0.f;
+				}
+			}
+
+			distance_transform(outside, field_size);
+			distance_transform(inside, field_size);
+
+			std::vector<u8> result(count);
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				//pixel centers sit half a pixel off the outline on both sides
+				float distance = outside[i] > 0.f ? std::sqrt(outside[i]) - 0.5f : 0.5f - std::sqrt(inside[i]);
+				float value = std::min(std::max(0.5f - distance / (2.f * spread), 0.f), 1.f);
+				result[i] = u8(value * 255.f + 0.5f);
+			}
+
+			return result;
+		}
+
+		static void add_dirty(coord2i &dirty, const coord2i &area_)
+		{
+			if (dirty.size.width() <= 0 || dirty.size.height() <= 0)
+			{
+				dirty = area_;
+				return;
+			}
+
+			point2i p1{ std::min(dirty.position.x(), area_.position.x()), std::min(dirty.position.y(), area_.position.y()) };
+			point2i p2{
+				std::max(dirty.position.x() + dirty.size.width(), area_.position.x() + area_.size.width()),
+				std::max(dirty.position.y() + dirty.size.height(), area_.position.y() + area_.size.height()) };
+
+			dirty = { p1, size2i{ p2.x() - p1.x(), p2.y() - p1.y() } };
+		}
+
+		glyph_atlas::glyph_atlas(std::size_t budget, size2i initial_page_size, int max_page_size)
+			: m_budget(budget)
+			, m_initial_page_size(initial_page_size)
+			, m_max_page_size(max_page_size)
+		{
+		}
+
+		std::size_t glyph_atlas::resident_bytes() const
+		{
+			std::size_t result = 0;
+
+			for (auto &page : m_pages)
+			{
+				result += page.pixels.size();
+			}
+
+			return result;
+		}
+
+		bool glyph_atlas::grow(page_t &page, bool over_budget)
+		{
+			size2i size = page.size;
+
+			if (size.width() >= m_max_page_size && size.height() >= m_max_page_size)
+			{
+				return false;
+			}
+
+			//grow the shorter side, pages stay close to square
+			if (size.height() < size.width())
+			{
+				size.height(std::min(size.height() * 2, m_max_page_size));
+			}
+			else
+			{
+				size.width(std::min(size.width() * 2, m_max_page_size));
+			}
+
+			std::size_t bytes = resident_bytes() - page.pixels.size() + std::size_t(size.width()) * size.height();
+
+			if (bytes > m_budget && !over_budget)
+			{
+				return false;
+			}
+
+			std::vector<u8> pixels(std::size_t(size.width()) * size.height());
+
+			for (int y = 0; y < page.size.height(); ++y)
+			{
+				std::memcpy(pixels.data() + std::size_t(y) * size.width(), page.pixels.data() + std::size_t(y) * page.size.width(), page.size.width());
+			}
+
+			page.pixels = std::move(pixels);
+			page.size = size;
+			page.packer.grow(size);
+			page.dirty = { {}, size };
+			return true;
+		}
+
+		void glyph_atlas::evict(u32 page)
+		{
+			for (auto it = m_glyphs.begin(); it != m_glyphs.end();)
+			{
+				if (it->second.page == page)
+				{
+					it = m_glyphs.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+
+			auto &page_ = m_pages[page];
+			std::fill(page_.pixels.begin(), page_.pixels.end(), u8(0));
+			page_.packer.reset(page_.size);
+			page_.dirty = { {}, page_.size };
+			++m_evictions;
+		}
+
+		bool glyph_atlas::allocate(size2i size, u32 &page, point2i &position)
+		{
+			if (size.width() > m_max_page_size || size.height() > m_max_page_size)
+			{
+				return false;
+			}
+
+			for (u32 i = 0; i < m_pages.size(); ++i)
+			{
+				if (m_pages[i].packer.pack(size, position))
+				{
+					page = i;
+					return true;
+				}
+			}
+
+			auto grow_pages = [&](bool over_budget)
+			{
+				for (u32 i = 0; i < m_pages.size(); ++i)
+				{
+					while (grow(m_pages[i], over_budget))
+					{
+						if (m_pages[i].packer.pack(size, position))
+						{
+							page = i;
+							return true;
+						}
+					}
+				}
+
+				return false;
+			};
+
+			if (grow_pages(false))
+			{
+				return true;
+			}
+
+			size2i page_size = m_initial_page_size;
+
+			while (page_size.width() < size.width() || page_size.height() < size.height())
+			{
+				page_size = { std::min(page_size.width() * 2, m_max_page_size), std::min(page_size.height() * 2, m_max_page_size) };
+			}
+
+			std::size_t page_bytes = std::size_t(page_size.width()) * page_size.height();
+
+			if (!m_pages.empty() && resident_bytes() + page_bytes > m_budget)
+			{
+				//least recently used page, unless it serves the current use
+				u32 oldest = no_page;
+
+				for (u32 i = 0; i < m_pages.size(); ++i)
+				{
+					if (m_pages[i].last_use < m_use && (oldest == no_page || m_pages[i].last_use < m_pages[oldest].last_use))
+					{
+						oldest = i;
+					}
+				}
+
+				if (oldest != no_page)
+				{
+					evict(oldest);
+
+					if (m_pages[oldest].packer.pack(size, position))
+					{
+						page = oldest;
+						return true;
+					}
+				}
+
+				//everything serves the current use, the budget is exceeded rather than dropping glyphs being drawn
+				if (grow_pages(true))
+				{
+					return true;
+				}
+			}
+
+			page_t new_page;
+			new_page.size = page_size;
+			new_page.pixels.resize(page_bytes);
+			new_page.packer.reset(page_size);
+			new_page.dirty = { {}, page_size };
+
+			m_pages.push_back(std::move(new_page));
+			page = u32(m_pages.size() - 1);
+			return m_pages.back().packer.pack(size, position);
+		}
+
+		void glyph_atlas::begin_use()
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			++m_use;
+		}
+
+		static bool rasterize(FT_Face ft_face, int size, u32 codepoint, glyph_mode mode, glyph_atlas::raster_t &result)
+		{
+			FT_Set_Pixel_Sizes(ft_face, 0, size);
+
+			if (FT_Load_Char(ft_face, codepoint, FT_LOAD_RENDER))
+			{
+				return false;
+			}
+
+			FT_GlyphSlot slot = ft_face->glyph;
+			size2i bitmap_size{ (int)slot->bitmap.width, (int)slot->bitmap.rows };
+			point2i bearing{ slot->bitmap_left, slot->bitmap_top };
+
+			result.advance = { int(slot->advance.x >> 6), int(slot->advance.y >> 6) };
+
+			if (mode == glyph_mode::sdf && bitmap_size.width() > 0 && bitmap_size.height() > 0)
+			{
+				result.pixels = signed_distance_field(slot->bitmap.buffer, slot->bitmap.pitch, bitmap_size, glyph_atlas::sdf_spread, bitmap_size);
+				bearing += point2i{ -glyph_atlas::sdf_spread, glyph_atlas::sdf_spread };
+			}
+			else
+			{
+				result.pixels.resize(std::size_t(bitmap_size.width()) * bitmap_size.height());
+
+				for (int y = 0; y < bitmap_size.height(); ++y)
+				{
+					std::memcpy(result.pixels.data() + std::size_t(y) * bitmap_size.width(),
+						slot->bitmap.buffer + std::ptrdiff_t(y) * slot->bitmap.pitch, bitmap_size.width());
+				}
+			}
+
+			result.coord = { bearing, bitmap_size };
+			return true;
+		}
+
+		glyph_atlas::glyph_t glyph_atlas::insert(const key_t &key, const raster_t *raster)
+		{
+			glyph_t glyph_;
+
+			if (raster)
+			{
+				glyph_.coord = raster->coord;
+				glyph_.advance = raster->advance;
+
+				size2i bitmap_size = raster->coord.size;
+				u32 page;
+				point2i position;
+
+				if (bitmap_size.width() > 0 && bitmap_size.height() > 0 &&
+					allocate({ bitmap_size.width() + m_padding * 2, bitmap_size.height() + m_padding * 2 }, page, position))
+				{
+					auto &page_ = m_pages[page];
+					position += point2i{ m_padding, m_padding };
+
+					for (int y = 0; y < bitmap_size.height(); ++y)
+					{
+						std::memcpy(page_.pixels.data() + std::size_t(position.y() + y) * page_.size.width() + position.x(),
+							raster->pixels.data() + std::size_t(y) * bitmap_size.width(), bitmap_size.width());
+					}
+
+					glyph_.page = page;
+					glyph_.atlas_coord = { position, bitmap_size };
+					page_.last_use = m_use;
+					add_dirty(page_.dirty, glyph_.atlas_coord);
+				}
+			}
+
+			m_glyphs.emplace(key, glyph_);
+			return glyph_;
+		}
+
+		bool glyph_atlas::glyph(const font::face &face, int size, u32 codepoint, glyph_t &result, glyph_mode mode)
+		{
+			if (mode == glyph_mode::sdf)
+			{
+				size = sdf_size;
+			}
+
+			key_t key{ face.ft_face, size, codepoint, mode };
+
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				auto found = m_glyphs.find(key);
+
+				if (found != m_glyphs.end())
+				{
+					result = found->second;
+
+					if (result.page != no_page)
+					{
+						m_pages[result.page].last_use = m_use;
+					}
+
+					return result.page != no_page;
+				}
+			}
+
+			//rasterized on the face of this thread, other threads keep using the atlas meanwhile
+			raster_t raster;
+			bool rasterized = rasterize((FT_Face)face.native(), size, codepoint, mode, raster);
+
+			std::lock_guard<std::mutex> lock(m_mtx);
+			auto found = m_glyphs.find(key);
+
+			if (found != m_glyphs.end())
+			{
+				result = found->second;
+
+				if (result.page != no_page)
+				{
+					m_pages[result.page].last_use = m_use;
+				}
+			}
+			else
+			{
+				result = insert(key, rasterized ? &raster : nullptr);
+			}
+
+			return result.page != no_page;
+		}
+
+		void glyph_atlas::prewarm(const font::face &face, int size, const std::vector<u32> &codepoints, glyph_mode mode)
+		{
+			glyph_t unused;
+
+			for (u32 codepoint : codepoints)
+			{
+				glyph(face, size, codepoint, unused, mode);
+			}
+		}
+
+		//header of a saved glyph set, followed by its records. every record is followed by its bitmap
+		struct saved_glyphs_header
+		{
+			static constexpr u32 magic_value = 0x47454652; //RFEG
+			static constexpr u32 version_value = 1;
+
+			u32 magic;
+			u32 version;
+			u32 count;
+		};
+
+		struct saved_glyph
+		{
+			u32 codepoint;
+			coord2i coord;
+			point2i advance;
+		};
+
+		std::vector<u8> glyph_atlas::save(const font::face &face, int size, glyph_mode mode) const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+
+			if (mode == glyph_mode::sdf)
+			{
+				size = sdf_size;
+			}
+
+			std::vector<u8> result(sizeof(saved_glyphs_header));
+			saved_glyphs_header header{ saved_glyphs_header::magic_value, saved_glyphs_header::version_value, 0 };
+
+			for (auto &entry : m_glyphs)
+			{
+				const key_t &key = entry.first;
+				const glyph_t &glyph_ = entry.second;
+
+				if (key.face != face.ft_face || key.size != size || key.mode != mode)
+				{
+					continue;
+				}
+
+				//a glyph with a bitmap that did not fit has nothing to restore
+				bool has_bitmap = glyph_.coord.size.width() > 0 && glyph_.coord.size.height() > 0;
+
+				if (has_bitmap && glyph_.page == no_page)
+				{
+					continue;
+				}
+
+				saved_glyph record{ key.codepoint, glyph_.coord, glyph_.advance };
+				std::size_t offset = result.size();
+				std::size_t bitmap_size = has_bitmap ? std::size_t(glyph_.coord.size.width()) * glyph_.coord.size.height() : 0;
+
+				result.resize(offset + sizeof(record) + bitmap_size);
+				std::memcpy(result.data() + offset, &record, sizeof(record));
+
+				if (has_bitmap)
+				{
+					auto &page_ = m_pages[glyph_.page];
+					u8 *bitmap = result.data() + offset + sizeof(record);
+					int width = glyph_.atlas_coord.size.width();
+
+					for (int y = 0; y < glyph_.atlas_coord.size.height(); ++y)
+					{
+						std::memcpy(bitmap + std::size_t(y) * width,
+							page_.pixels.data() + std::size_t(glyph_.atlas_coord.position.y() + y) * page_.size.width() + glyph_.atlas_coord.position.x(), width);
+					}
+				}
+
+				++header.count;
+			}
+
+			std::memcpy(result.data(), &header, sizeof(header));
+			return result;
+		}
+
+		bool glyph_atlas::load(const font::face &face, int size, glyph_mode mode, const u8 *data, std::size_t data_size)
+		{
+			saved_glyphs_header header;
+
+			if (data_size < sizeof(header))
+			{
+				return false;
+			}
+
+			std::memcpy(&header, data, sizeof(header));
+
+			if (header.magic != saved_glyphs_header::magic_value || header.version != saved_glyphs_header::version_value)
+			{
+				return false;
+			}
+
+			if (mode == glyph_mode::sdf)
+			{
+				size = sdf_size;
+			}
+
+			std::lock_guard<std::mutex> lock(m_mtx);
+			std::size_t offset = sizeof(header);
+
+			for (u32 i = 0; i < header.count; ++i)
+			{
+				saved_glyph record;
+
+				if (data_size - offset < sizeof(record))
+				{
+					return false;
+				}
+
+				std::memcpy(&record, data + offset, sizeof(record));
+				offset += sizeof(record);
+
+				int width = std::max(record.coord.size.width(), 0);
+				int height = std::max(record.coord.size.height(), 0);
+				std::size_t bitmap_size = std::size_t(width) * height;
+
+				if (data_size - offset < bitmap_size)
+				{
+					return false;
+				}
+
+				key_t key{ face.ft_face, size, record.codepoint, mode };
+
+				if (m_glyphs.find(key) == m_glyphs.end())
+				{
+					raster_t raster;
+					raster.coord = record.coord;
+					raster.advance = record.advance;
+					raster.pixels.assign(data + offset, data + offset + bitmap_size);
+					insert(key, &raster);
+				}
+
+				offset += bitmap_size;
+			}
+
+			return true;
+		}
+
+		int glyph_atlas::kerning(const font::face &face, int size, u32 left, u32 right, glyph_mode mode)
+		{
+			if (!FT_HAS_KERNING((FT_Face)face.ft_face))
+			{
+				return 0;
+			}
+
+			if (mode == glyph_mode::sdf)
+			{
+				size = sdf_size;
+			}
+
+			kerning_key_t key{ face.ft_face, size, left, right };
+
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				auto found = m_kernings.find(key);
+
+				if (found != m_kernings.end())
+				{
+					return found->second;
+				}
+			}
+
+			FT_Face ft_face = (FT_Face)face.native();
+			FT_Set_Pixel_Sizes(ft_face, 0, size);
+
+			FT_Vector delta{};
+			int result = 0;
+
+			if (!FT_Get_Kerning(ft_face, FT_Get_Char_Index(ft_face, left), FT_Get_Char_Index(ft_face, right), FT_KERNING_DEFAULT, &delta))
+			{
+				result = int(delta.x >> 6);
+			}
+
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_kernings.emplace(key, result);
+			return result;
+		}
+
+		glyph_atlas::line_metrics_t glyph_atlas::line_metrics(const font::face &face, int size)
+		{
+			FT_Face ft_face = (FT_Face)face.native();
+			FT_Set_Pixel_Sizes(ft_face, 0, size);
+
+			const FT_Size_Metrics &metrics = ft_face->size->metrics;
+			return{ int(metrics.ascender >> 6), int(-metrics.descender >> 6), int(metrics.height >> 6) };
+		}
+
+		u64 glyph_atlas::evictions() const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_evictions;
+		}
+
+		std::size_t glyph_atlas::page_count() const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_pages.size();
+		}
+
+		size2i glyph_atlas::page_size(u32 page) const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_pages[page].size;
+		}
+
+		void glyph_atlas::sync_page(u32 page, const std::function<void(const page_t&, const coord2i&)> &upload)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			auto &page_ = m_pages[page];
+
+			if (page_.dirty.size.width() <= 0 || page_.dirty.size.height() <= 0)
+			{
+				return;
+			}
+
+			upload(page_, page_.dirty);
+			page_.dirty = {};
+		}
+	}
+}
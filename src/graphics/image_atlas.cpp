@@ -0,0 +1,266 @@
+#include <rfe/graphics/image_atlas.h>
+#include <rfe/graphics/pixel_convert.h>
+#include <algorithm>
+#include <cstring>
+
+namespace rfe
+{
+	namespace graphics
+	{
+		static int align(int value, int alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		static void add_dirty(coord2i &dirty, const coord2i &area_)
+		{
+			if (dirty.size.width() <= 0 || dirty.size.height() <= 0)
+			{
+				dirty = area_;
+				return;
+			}
+
+			point2i p1{ std::min(dirty.position.x(), area_.position.x()), std::min(dirty.position.y(), area_.position.y()) };
+			point2i p2{
+				std::max(dirty.position.x() + dirty.size.width(), area_.position.x() + area_.size.width()),
+				std::max(dirty.position.y() + dirty.size.height(), area_.position.y() + area_.size.height()) };
+
+			dirty = { p1, size2i{ p2.x() - p1.x(), p2.y() - p1.y() } };
+		}
+
+		image_atlas::image_atlas()
+			: image_atlas(settings{})
+		{
+		}
+
+		image_atlas::image_atlas(const settings &settings_)
+			: m_settings(settings_)
+		{
+			m_settings.alignment = std::max(m_settings.alignment, 1);
+			//packed blocks start aligned, a whole number of alignments keeps the image inside aligned too
+			m_settings.padding = align(std::max(m_settings.padding, 0), m_settings.alignment);
+		}
+
+		const image_atlas::placement_t* image_atlas::find(const std::shared_ptr<image> &image_) const
+		{
+			auto found = m_placements.find(image_.get());
+
+			//the address may belong to a new image once the packed one went
+			if (found == m_placements.end() || found->second.source.lock() != image_)
+			{
+				return nullptr;
+			}
+
+			return &found->second;
+		}
+
+		void image_atlas::release_expired()
+		{
+			std::vector<std::size_t> live(m_pages.size());
+
+			for (auto it = m_placements.begin(); it != m_placements.end();)
+			{
+				if (it->second.source.expired())
+				{
+					it = m_placements.erase(it);
+				}
+				else
+				{
+					++live[it->second.page];
+					++it;
+				}
+			}
+
+			//remapped textures hold their page, its space is reused only once none is left
+			for (std::size_t i = 0; i < m_pages.size(); ++i)
+			{
+				if (!live[i] && m_pages[i].pixels.use_count() == 1)
+				{
+					m_pages[i].packer.reset(m_settings.page_size);
+				}
+			}
+		}
+
+		std::size_t image_atlas::pack(const size2i &packed, point2i &position)
+		{
+			std::size_t page_index = 0;
+
+			while (page_index < m_pages.size() && !m_pages[page_index].packer.pack(packed, position))
+			{
+				++page_index;
+			}
+
+			return page_index;
+		}
+
+		void image_atlas::copy(page_t &page, const image &source, point2i position)
+		{
+			size2i size = source.size();
+			size2i page_size = m_settings.page_size;
+			int padding = m_settings.padding;
+			int source_pixel = source.type() == pixels_type::rgb8 ? 3 : 4;
+			bool flipped = source.origin() == image_origin::top_left;
+			u8 *page_pixels = (u8*)page.pixels->get();
+
+			//rows and columns of the padding repeat the nearest edge of the image
+			for (int y = -padding; y < size.height() + padding; ++y)
+			{
+				int page_y = position.y() + y;
+
+				if (page_y < 0 || page_y >= page_size.height())
+				{
+					continue;
+				}
+
+				//pages are bottom_left, top_left images go in upside down
+				int source_y = std::min(std::max(y, 0), size.height() - 1);
+				const u8 *source_row = (const u8*)source.row(flipped ? size.height() - 1 - source_y : source_y);
+				u8 *page_row = page_pixels + std::size_t(page_y) * page_size.width() * 4;
+				int first = std::max(position.x(), 0);
+				int last = std::min(position.x() + size.width(), page_size.width());
+
+				if (first < last)
+				{
+					const u8 *from = source_row + std::size_t(first - position.x()) * source_pixel;
+
+					if (source_pixel == 3)
+					{
+						convert::rgb_to_rgba(from, page_row + first * 4, last - first);
+					}
+					else
+					{
+						std::memcpy(page_row + first * 4, from, std::size_t(last - first) * 4);
+					}
+				}
+
+				for (int x = 1; x <= padding; ++x)
+				{
+					int left = position.x() - x;
+					int right = position.x() + size.width() - 1 + x;
+
+					if (left >= 0)
+					{
+						std::memcpy(page_row + left * 4, page_row + position.x() * 4, 4);
+					}
+
+					if (right < page_size.width())
+					{
+						std::memcpy(page_row + right * 4, page_row + (position.x() + size.width() - 1) * 4, 4);
+					}
+				}
+			}
+		}
+
+		bool image_atlas::add(const std::shared_ptr<image> &image_)
+		{
+			if (!image_ || image_->empty())
+			{
+				return false;
+			}
+
+			size2i size = image_->size();
+
+			if (size.width() > m_settings.max_image_size || size.height() > m_settings.max_image_size ||
+				(image_->type() != pixels_type::rgba8 && image_->type() != pixels_type::rgb8))
+			{
+				return false;
+			}
+
+			int padding = m_settings.padding;
+			int alignment = m_settings.alignment;
+			size2i packed{ align(size.width() + padding * 2, alignment), align(size.height() + padding * 2, alignment) };
+
+			if (packed.width() > m_settings.page_size.width() || packed.height() > m_settings.page_size.height())
+			{
+				return false;
+			}
+
+			std::lock_guard<std::mutex> lock(m_mtx);
+
+			if (find(image_))
+			{
+				return true;
+			}
+
+			point2i position;
+			std::size_t page_index = pack(packed, position);
+
+			if (page_index == m_pages.size())
+			{
+				release_expired();
+				page_index = pack(packed, position);
+			}
+
+			if (page_index == m_pages.size())
+			{
+				page_t page;
+				std::size_t bytes = std::size_t(m_settings.page_size.width()) * m_settings.page_size.height() * 4;
+				auto pixels = std::make_unique<char[]>(bytes);
+				std::memset(pixels.get(), 0, bytes);
+
+				page.pixels = std::make_shared<image>(std::move(pixels), m_settings.page_size, pixels_type::rgba8);
+				page.pixels->updates(std::make_shared<image_updates>());
+				page.packer.reset(m_settings.page_size);
+				page.packer.pack(packed, position);
+				m_pages.push_back(std::move(page));
+			}
+
+			page_t &page = m_pages[page_index];
+
+			position += point2i{ padding, padding };
+
+			{
+				//the render thread reads the page under the same lock and uploads only the marked area
+				auto &updates = *page.pixels->updates();
+				std::lock_guard<std::mutex> updates_lock(updates.mtx);
+
+				copy(page, *image_, position);
+
+				point2i first{ std::max(position.x() - padding, 0), std::max(position.y() - padding, 0) };
+				point2i last{
+					std::min(position.x() + size.width() + padding, m_settings.page_size.width()),
+					std::min(position.y() + size.height() + padding, m_settings.page_size.height()) };
+
+				add_dirty(updates.dirty, { first, size2i{ last.x() - first.x(), last.y() - first.y() } });
+				page.pixels->touch();
+			}
+
+			m_placements[image_.get()] = { image_, page_index, position, size };
+			return true;
+		}
+
+		texture image_atlas::remap(const texture &texture_)
+		{
+			const auto &image_ = texture_.image_ptr();
+
+			if (!add(image_))
+			{
+				return texture_;
+			}
+
+			std::lock_guard<std::mutex> lock(m_mtx);
+			const placement_t *placement = find(image_);
+			size2f page_size{ (float)m_settings.page_size.width(), (float)m_settings.page_size.height() };
+
+			std::vector<point2f> coords(texture_.coords_count());
+
+			for (std::size_t i = 0; i < coords.size(); ++i)
+			{
+				const point2f &coord = texture_.coord(i);
+
+				coords[i] = {
+					(placement->position.x() + coord.x() * placement->size.width()) / page_size.width(),
+					(placement->position.y() + coord.y() * placement->size.height()) / page_size.height()
+				};
+			}
+
+			return texture(m_pages[placement->page].pixels, coords);
+		}
+
+		std::size_t image_atlas::pages() const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_pages.size();
+		}
+	}
+}
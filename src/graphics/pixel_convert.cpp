@@ -0,0 +1,633 @@
+#include <rfe/graphics/pixel_convert.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define RFE_CONVERT_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RFE_TARGET_AVX2
+#else
+#define RFE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace rfe
+{
+	namespace graphics
+	{
+		namespace convert
+		{
+			static isa detect()
+			{
+#ifndef RFE_CONVERT_X86
+				return isa::scalar;
+#elif defined(_MSC_VER)
+				int info[4];
+				__cpuid(info, 0);
+				int leaves = info[0];
+
+				__cpuid(info, 1);
+				bool osxsave = (info[2] & (1 << 27)) != 0;
+				bool avx = (info[2] & (1 << 28)) != 0;
+
+				//the os has to save the ymm registers too
+				if (leaves >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+				{
+					__cpuidex(info, 7, 0);
+
+					if (info[1] & (1 << 5))
+					{
+						return isa::avx2;
+					}
+				}
+
+				return isa::sse2;
+#else
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("avx2") ? isa::avx2 : isa::sse2;
+#endif
+			}
+
+			static std::atomic<isa>& current()
+			{
+				static std::atomic<isa> result{ supported() };
+				return result;
+			}
+
+			isa supported()
+			{
+				static const isa result = detect();
+				return result;
+			}
+
+			void use(isa set)
+			{
+				current() = std::min(set, supported());
+			}
+
+			isa active()
+			{
+				return current();
+			}
+
+			//elements the simd kernel of the active set converted, the scalar one does the rest
+			template<typename Sse2Type, typename Avx2Type>
+			static std::size_t vectorized(Sse2Type sse2, Avx2Type avx2)
+			{
+				switch (active())
+				{
+				case isa::avx2: return avx2();
+				case isa::sse2: return sse2();
+				default: return 0;
+				}
+			}
+
+			static const float* srgb_to_linear_table()
+			{
+				static const struct table_t
+				{
+					float values[256];
+
+					table_t()
+					{
+						for (int i = 0; i < 256; ++i)
+						{
+							float c = i / 255.f;
+							values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+						}
+					}
+				} table;
+
+				return table.values;
+			}
+
+			//linear values in 4096 steps, the curve is flat enough near zero for 8 bit results.
+			//padded so 32 bit loads at the last entry stay inside
+			static const u8* linear_to_srgb_table()
+			{
+				static const struct table_t
+				{
+					u8 values[4096 + 3] = {};
+
+					table_t()
+					{
+						for (int i = 0; i < 4096; ++i)
+						{
+							float c = i / 4095.f;
+							float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.f / 2.4f) - 0.055f;
+							values[i] = u8(std::min(std::max(s, 0.f), 1.f) * 255.f + 0.5f);
+						}
+					}
+				} table;
+
+				return table.values;
+			}
+
+#ifdef RFE_CONVERT_X86
+			static std::size_t expand_palette_avx2(const u8 *indices, const u8 *palette, u8 *rgba, std::size_t count) RFE_TARGET_AVX2;
+			static std::size_t expand_gray_sse2(const u8 *gray, u8 *rgba, std::size_t count);
+			static std::size_t expand_gray_avx2(const u8 *gray, u8 *rgba, std::size_t count) RFE_TARGET_AVX2;
+			static std::size_t expand_gray_alpha_sse2(const u8 *gray_alpha, u8 *rgba, std::size_t count);
+			static std::size_t expand_gray_alpha_avx2(const u8 *gray_alpha, u8 *rgba, std::size_t count) RFE_TARGET_AVX2;
+			static std::size_t narrow_16_sse2(const u8 *samples, u8 *result, std::size_t count);
+			static std::size_t narrow_16_avx2(const u8 *samples, u8 *result, std::size_t count) RFE_TARGET_AVX2;
+			static std::size_t rgb_to_rgba_avx2(const u8 *rgb, u8 *rgba, std::size_t count) RFE_TARGET_AVX2;
+			static std::size_t swizzle_rb_sse2(const u8 *source, u8 *result, std::size_t count);
+			static std::size_t swizzle_rb_avx2(const u8 *source, u8 *result, std::size_t count) RFE_TARGET_AVX2;
+			static std::size_t premultiply_sse2(const u8 *rgba, u8 *result, std::size_t count);
+			static std::size_t premultiply_avx2(const u8 *rgba, u8 *result, std::size_t count) RFE_TARGET_AVX2;
+			static std::size_t srgb_to_linear_avx2(const u8 *rgba, float *linear, std::size_t count) RFE_TARGET_AVX2;
+			static std::size_t linear_to_srgb_sse2(const float *linear, u8 *rgba, std::size_t count);
+			static std::size_t linear_to_srgb_avx2(const float *linear, u8 *rgba, std::size_t count) RFE_TARGET_AVX2;
+
+			static std::size_t expand_palette_avx2(const u8 *indices, const u8 *palette, u8 *rgba, std::size_t count)
+			{
+				std::size_t i = 0;
+
+				for (; i + 8 <= count; i += 8)
+				{
+					__m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(indices + i)));
+					__m256i pixels = _mm256_i32gather_epi32((const int*)palette, index, 4);
+					_mm256_storeu_si256((__m256i*)(rgba + i * 4), pixels);
+				}
+
+				return i;
+			}
+
+			static std::size_t expand_gray_sse2(const u8 *gray, u8 *rgba, std::size_t count)
+			{
+				const __m128i opaque = _mm_set1_epi8(-1);
+				std::size_t i = 0;
+
+				for (; i + 16 <= count; i += 16)
+				{
+					__m128i g = _mm_loadu_si128((const __m128i*)(gray + i));
+					__m128i gg_lo = _mm_unpacklo_epi8(g, g);
+					__m128i gg_hi = _mm_unpackhi_epi8(g, g);
+					__m128i ga_lo = _mm_unpacklo_epi8(g, opaque);
+					__m128i ga_hi = _mm_unpackhi_epi8(g, opaque);
+
+					__m128i *to = (__m128i*)(rgba + i * 4);
+					_mm_storeu_si128(to + 0, _mm_unpacklo_epi16(gg_lo, ga_lo));
+					_mm_storeu_si128(to + 1, _mm_unpackhi_epi16(gg_lo, ga_lo));
+					_mm_storeu_si128(to + 2, _mm_unpacklo_epi16(gg_hi, ga_hi));
+					_mm_storeu_si128(to + 3, _mm_unpackhi_epi16(gg_hi, ga_hi));
+				}
+
+				return i;
+			}
+
+			static std::size_t expand_gray_avx2(const u8 *gray, u8 *rgba, std::size_t count)
+			{
+				const __m256i spread = _mm256_set1_epi32(0x010101);
+				const __m256i opaque = _mm256_set1_epi32(int(0xff000000));
+				std::size_t i = 0;
+
+				for (; i + 8 <= count; i += 8)
+				{
+					__m256i g = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(gray + i)));
+					_mm256_storeu_si256((__m256i*)(rgba + i * 4), _mm256_or_si256(_mm256_mullo_epi32(g, spread), opaque));
+				}
+
+				return i;
+			}
+
+			static std::size_t expand_gray_alpha_sse2(const u8 *gray_alpha, u8 *rgba, std::size_t count)
+			{
+				const __m128i keep = _mm_set1_epi32(int(0xffff00ff));
+				const __m128i low = _mm_set1_epi32(0xff);
+				std::size_t i = 0;
+
+				for (; i + 8 <= count; i += 8)
+				{
+					__m128i pairs = _mm_loadu_si128((const __m128i*)(gray_alpha + i * 2));
+					//g a g a, the second byte becomes gray
+					__m128i lo = _mm_unpacklo_epi16(pairs, pairs);
+					__m128i hi = _mm_unpackhi_epi16(pairs, pairs);
+					lo = _mm_or_si128(_mm_and_si128(lo, keep), _mm_slli_epi32(_mm_and_si128(lo, low), 8));
+					hi = _mm_or_si128(_mm_and_si128(hi, keep), _mm_slli_epi32(_mm_and_si128(hi, low), 8));
+
+					__m128i *to = (__m128i*)(rgba + i * 4);
+					_mm_storeu_si128(to + 0, lo);
+					_mm_storeu_si128(to + 1, hi);
+				}
+
+				return i;
+			}
+
+			static std::size_t expand_gray_alpha_avx2(const u8 *gray_alpha, u8 *rgba, std::size_t count)
+			{
+				const __m256i spread = _mm256_set1_epi32(0x010101);
+				const __m256i low = _mm256_set1_epi32(0xff);
+				const __m256i alpha = _mm256_set1_epi32(0xff00);
+				std::size_t i = 0;
+
+				for (; i + 8 <= count; i += 8)
+				{
+					__m256i pairs = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(gray_alpha + i * 2)));
+					__m256i g = _mm256_mullo_epi32(_mm256_and_si256(pairs, low), spread);
+					__m256i a = _mm256_slli_epi32(_mm256_and_si256(pairs, alpha), 16);
+					_mm256_storeu_si256((__m256i*)(rgba + i * 4), _mm256_or_si256(g, a));
+				}
+
+				return i;
+			}
+
+			static std::size_t narrow_16_sse2(const u8 *samples, u8 *result, std::size_t count)
+			{
+				//the high byte comes first, it is the low one of a little endian lane
+				const __m128i high = _mm_set1_epi16(0xff);
+				std::size_t i = 0;
+
+				for (; i + 16 <= count; i += 16)
+				{
+					__m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i*)(samples + i * 2)), high);
+					__m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i*)(samples + i * 2 + 16)), high);
+					_mm_storeu_si128((__m128i*)(result + i), _mm_packus_epi16(a, b));
+				}
+
+				return i;
+			}
+
+			static std::size_t narrow_16_avx2(const u8 *samples, u8 *result, std::size_t count)
+			{
+				const __m256i high = _mm256_set1_epi16(0xff);
+				std::size_t i = 0;
+
+				for (; i + 32 <= count; i += 32)
+				{
+					__m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(samples + i * 2)), high);
+					__m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(samples + i * 2 + 32)), high);
+					//packs work per 128 bit lane, the quarters are put back in order
+					__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+					_mm256_storeu_si256((__m256i*)(result + i), packed);
+				}
+
+				return i;
+			}
+
+			static std::size_t rgb_to_rgba_avx2(const u8 *rgb, u8 *rgba, std::size_t count)
+			{
+				//each lane gets the 12 bytes of 4 pixels, then they are spread to 16
+				const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5);
+				const __m256i spread = _mm256_setr_epi8(
+					0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+					0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+				const __m256i opaque = _mm256_set1_epi32(int(0xff000000));
+				std::size_t i = 0;
+
+				//a load reads 32 bytes for the 24 of 8 pixels
+				for (; i + 11 <= count; i += 8)
+				{
+					__m256i pixels = _mm256_loadu_si256((const __m256i*)(rgb + i * 3));
+					pixels = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(pixels, lanes), spread);
+					_mm256_storeu_si256((__m256i*)(rgba + i * 4), _mm256_or_si256(pixels, opaque));
+				}
+
+				return i;
+			}
+
+			static std::size_t swizzle_rb_sse2(const u8 *source, u8 *result, std::size_t count)
+			{
+				const __m128i green_alpha = _mm_set1_epi32(int(0xff00ff00));
+				const __m128i red_blue = _mm_set1_epi32(0x00ff00ff);
+				std::size_t i = 0;
+
+				for (; i + 4 <= count; i += 4)
+				{
+					__m128i pixels = _mm_loadu_si128((const __m128i*)(source + i * 4));
+					__m128i rb = _mm_and_si128(pixels, red_blue);
+					rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+					_mm_storeu_si128((__m128i*)(result + i * 4), _mm_or_si128(_mm_and_si128(pixels, green_alpha), rb));
+				}
+
+				return i;
+			}
+
+			static std::size_t swizzle_rb_avx2(const u8 *source, u8 *result, std::size_t count)
+			{
+				const __m256i green_alpha = _mm256_set1_epi32(int(0xff00ff00));
+				const __m256i red_blue = _mm256_set1_epi32(0x00ff00ff);
+				std::size_t i = 0;
+
+				for (; i + 8 <= count; i += 8)
+				{
+					__m256i pixels = _mm256_loadu_si256((const __m256i*)(source + i * 4));
+					__m256i rb = _mm256_and_si256(pixels, red_blue);
+					rb = _mm256_or_si256(_mm256_slli_epi32(rb, 16), _mm256_srli_epi32(rb, 16));
+					_mm256_storeu_si256((__m256i*)(result + i * 4), _mm256_or_si256(_mm256_and_si256(pixels, green_alpha), rb));
+				}
+
+				return i;
+			}
+
+			//c * a / 255 rounded, exactly as the scalar version. alpha is multiplied by 255 and stays
+			static __m128i premultiply_sse2(__m128i pixels)
+			{
+				const __m128i colors = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+				const __m128i alpha = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+				const __m128i half = _mm_set1_epi16(128);
+
+				__m128i factor = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				factor = _mm_or_si128(_mm_and_si128(factor, colors), alpha);
+
+				__m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels, factor), half);
+				return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+			}
+
+			static std::size_t premultiply_sse2(const u8 *rgba, u8 *result, std::size_t count)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				std::size_t i = 0;
+
+				for (; i + 4 <= count; i += 4)
+				{
+					__m128i pixels = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+					__m128i lo = premultiply_sse2(_mm_unpacklo_epi8(pixels, zero));
+					__m128i hi = premultiply_sse2(_mm_unpackhi_epi8(pixels, zero));
+					_mm_storeu_si128((__m128i*)(result + i * 4), _mm_packus_epi16(lo, hi));
+				}
+
+				return i;
+			}
+
+			static __m256i premultiply_avx2(__m256i pixels) RFE_TARGET_AVX2;
+
+			static __m256i premultiply_avx2(__m256i pixels)
+			{
+				const __m256i colors = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+				const __m256i alpha = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+				const __m256i half = _mm256_set1_epi16(128);
+
+				__m256i factor = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				factor = _mm256_or_si256(_mm256_and_si256(factor, colors), alpha);
+
+				__m256i product = _mm256_add_epi16(_mm256_mullo_epi16(pixels, factor), half);
+				return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+			}
+
+			static std::size_t premultiply_avx2(const u8 *rgba, u8 *result, std::size_t count)
+			{
+				const __m256i zero = _mm256_setzero_si256();
+				std::size_t i = 0;
+
+				for (; i + 8 <= count; i += 8)
+				{
+					//unpacks and packs both work per lane, the order comes back as it was
+					__m256i pixels = _mm256_loadu_si256((const __m256i*)(rgba + i * 4));
+					__m256i lo = premultiply_avx2(_mm256_unpacklo_epi8(pixels, zero));
+					__m256i hi = premultiply_avx2(_mm256_unpackhi_epi8(pixels, zero));
+					_mm256_storeu_si256((__m256i*)(result + i * 4), _mm256_packus_epi16(lo, hi));
+				}
+
+				return i;
+			}
+
+			static std::size_t srgb_to_linear_avx2(const u8 *rgba, float *linear, std::size_t count)
+			{
+				const float *table = srgb_to_linear_table();
+				const __m256 scale = _mm256_set1_ps(255.f);
+				std::size_t i = 0;
+
+				for (; i + 2 <= count; i += 2)
+				{
+					__m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(rgba + i * 4)));
+					__m256 colors = _mm256_i32gather_ps(table, index, 4);
+					__m256 alpha = _mm256_div_ps(_mm256_cvtepi32_ps(index), scale);
+					_mm256_storeu_ps(linear + i * 4, _mm256_blend_ps(colors, alpha, 0x88));
+				}
+
+				return i;
+			}
+
+			static std::size_t linear_to_srgb_sse2(const float *linear, u8 *rgba, std::size_t count)
+			{
+				const u8 *table = linear_to_srgb_table();
+				const __m128 scale = _mm_setr_ps(4095.f, 4095.f, 4095.f, 255.f);
+				const __m128 half = _mm_set1_ps(0.5f);
+				const __m128 one = _mm_set1_ps(1.f);
+				const __m128 zero = _mm_setzero_ps();
+				alignas(16) int index[4];
+				std::size_t i = 0;
+
+				for (; i < count; ++i)
+				{
+					__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(linear + i * 4), zero), one);
+					_mm_store_si128((__m128i*)index, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half)));
+
+					u8 *to = rgba + i * 4;
+					to[0] = table[index[0]];
+					to[1] = table[index[1]];
+					to[2] = table[index[2]];
+					to[3] = u8(index[3]);
+				}
+
+				return i;
+			}
+
+			static std::size_t linear_to_srgb_avx2(const float *linear, u8 *rgba, std::size_t count)
+			{
+				const u8 *table = linear_to_srgb_table();
+				const __m256 scale = _mm256_setr_ps(4095.f, 4095.f, 4095.f, 255.f, 4095.f, 4095.f, 4095.f, 255.f);
+				const __m256 half = _mm256_set1_ps(0.5f);
+				const __m256 one = _mm256_set1_ps(1.f);
+				const __m256 zero = _mm256_setzero_ps();
+				const __m256i low = _mm256_set1_epi32(0xff);
+				std::size_t i = 0;
+
+				for (; i + 2 <= count; i += 2)
+				{
+					__m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(linear + i * 4), zero), one);
+					__m256i index = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, scale), half));
+					//the table is padded, 32 bit gathers of its bytes keep only the first one
+					__m256i colors = _mm256_and_si256(_mm256_i32gather_epi32((const int*)table, index, 1), low);
+					__m256i pixels = _mm256_blend_epi32(colors, index, 0x88);
+
+					pixels = _mm256_packs_epi32(pixels, pixels);
+					pixels = _mm256_packus_epi16(pixels, pixels);
+					u32 first = (u32)_mm_cvtsi128_si32(_mm256_castsi256_si128(pixels));
+					u32 second = (u32)_mm_cvtsi128_si32(_mm256_extracti128_si256(pixels, 1));
+					std::memcpy(rgba + i * 4, &first, 4);
+					std::memcpy(rgba + i * 4 + 4, &second, 4);
+				}
+
+				return i;
+			}
+#else
+			static std::size_t expand_palette_avx2(const u8*, const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t expand_gray_sse2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t expand_gray_avx2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t expand_gray_alpha_sse2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t expand_gray_alpha_avx2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t narrow_16_sse2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t narrow_16_avx2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t rgb_to_rgba_avx2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t swizzle_rb_sse2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t swizzle_rb_avx2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t premultiply_sse2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t premultiply_avx2(const u8*, u8*, std::size_t) { return 0; }
+			static std::size_t srgb_to_linear_avx2(const u8*, float*, std::size_t) { return 0; }
+			static std::size_t linear_to_srgb_sse2(const float*, u8*, std::size_t) { return 0; }
+			static std::size_t linear_to_srgb_avx2(const float*, u8*, std::size_t) { return 0; }
+#endif
+
+			//index of pixel i of a row of packed samples, the leftmost one is in the high bits
+			static u8 sample(const u8 *row, int bit_depth, std::size_t i)
+			{
+				if (bit_depth == 8)
+				{
+					return row[i];
+				}
+
+				std::size_t bit = i * bit_depth;
+				int shift = 8 - bit_depth - int(bit & 7);
+				return u8((row[bit >> 3] >> shift) & ((1 << bit_depth) - 1));
+			}
+
+			void expand_palette(const u8 *indices, int bit_depth, const u8 *palette, u8 *rgba, std::size_t count)
+			{
+				std::size_t done = 0;
+
+				if (bit_depth == 8)
+				{
+					done = vectorized([&] { return std::size_t(0); }, [&] { return expand_palette_avx2(indices, palette, rgba, count); });
+				}
+
+				for (std::size_t i = done; i < count; ++i)
+				{
+					std::memcpy(rgba + i * 4, palette + sample(indices, bit_depth, i) * 4, 4);
+				}
+			}
+
+			void expand_gray(const u8 *gray, int bit_depth, u8 *rgba, std::size_t count)
+			{
+				std::size_t done = 0;
+				int scale = 255 / ((1 << bit_depth) - 1);
+
+				if (bit_depth == 8)
+				{
+					done = vectorized([&] { return expand_gray_sse2(gray, rgba, count); }, [&] { return expand_gray_avx2(gray, rgba, count); });
+				}
+
+				for (std::size_t i = done; i < count; ++i)
+				{
+					u8 value = u8(sample(gray, bit_depth, i) * scale);
+					u8 *to = rgba + i * 4;
+					to[0] = value;
+					to[1] = value;
+					to[2] = value;
+					to[3] = 0xff;
+				}
+			}
+
+			void expand_gray_alpha(const u8 *gray_alpha, u8 *rgba, std::size_t count)
+			{
+				std::size_t done = vectorized([&] { return expand_gray_alpha_sse2(gray_alpha, rgba, count); }, [&] { return expand_gray_alpha_avx2(gray_alpha, rgba, count); });
+
+				for (std::size_t i = done; i < count; ++i)
+				{
+					u8 *to = rgba + i * 4;
+					to[0] = gray_alpha[i * 2];
+					to[1] = gray_alpha[i * 2];
+					to[2] = gray_alpha[i * 2];
+					to[3] = gray_alpha[i * 2 + 1];
+				}
+			}
+
+			void narrow_16(const u8 *samples, u8 *result, std::size_t count)
+			{
+				std::size_t done = vectorized([&] { return narrow_16_sse2(samples, result, count); }, [&] { return narrow_16_avx2(samples, result, count); });
+
+				for (std::size_t i = done; i < count; ++i)
+				{
+					result[i] = samples[i * 2];
+				}
+			}
+
+			void rgb_to_rgba(const u8 *rgb, u8 *rgba, std::size_t count)
+			{
+				//sse2 has no byte shuffle, rows stay scalar there
+				std::size_t done = vectorized([&] { return std::size_t(0); }, [&] { return rgb_to_rgba_avx2(rgb, rgba, count); });
+
+				for (std::size_t i = done; i < count; ++i)
+				{
+					u8 *to = rgba + i * 4;
+					to[0] = rgb[i * 3];
+					to[1] = rgb[i * 3 + 1];
+					to[2] = rgb[i * 3 + 2];
+					to[3] = 0xff;
+				}
+			}
+
+			void swizzle_rb(const u8 *source, u8 *result, std::size_t count)
+			{
+				std::size_t done = vectorized([&] { return swizzle_rb_sse2(source, result, count); }, [&] { return swizzle_rb_avx2(source, result, count); });
+
+				for (std::size_t i = done; i < count; ++i)
+				{
+					u8 r = source[i * 4];
+					u8 g = source[i * 4 + 1];
+					u8 b = source[i * 4 + 2];
+					u8 a = source[i * 4 + 3];
+					result[i * 4] = b;
+					result[i * 4 + 1] = g;
+					result[i * 4 + 2] = r;
+					result[i * 4 + 3] = a;
+				}
+			}
+
+			void premultiply(const u8 *rgba, u8 *result, std::size_t count)
+			{
+				std::size_t done = vectorized([&] { return premultiply_sse2(rgba, result, count); }, [&] { return premultiply_avx2(rgba, result, count); });
+
+				for (std::size_t i = done; i < count; ++i)
+				{
+					int a = rgba[i * 4 + 3];
+
+					for (int c = 0; c < 3; ++c)
+					{
+						int product = rgba[i * 4 + c] * a + 128;
+						result[i * 4 + c] = u8((product + (product >> 8)) >> 8);
+					}
+
+					result[i * 4 + 3] = u8(a);
+				}
+			}
+
+			void srgb_to_linear(const u8 *rgba, float *linear, std::size_t count)
+			{
+				const float *table = srgb_to_linear_table();
+				std::size_t done = vectorized([&] { return std::size_t(0); }, [&] { return srgb_to_linear_avx2(rgba, linear, count); });
+
+				for (std::size_t i = done; i < count; ++i)
+				{
+					linear[i * 4] = table[rgba[i * 4]];
+					linear[i * 4 + 1] = table[rgba[i * 4 + 1]];
+					linear[i * 4 + 2] = table[rgba[i * 4 + 2]];
+					linear[i * 4 + 3] = rgba[i * 4 + 3] / 255.f;
+				}
+			}
+
+			void linear_to_srgb(const float *linear, u8 *rgba, std::size_t count)
+			{
+				const u8 *table = linear_to_srgb_table();
+				std::size_t done = vectorized([&] { return linear_to_srgb_sse2(linear, rgba, count); }, [&] { return linear_to_srgb_avx2(linear, rgba, count); });
+
+				for (std::size_t i = done; i < count; ++i)
+				{
+					for (int c = 0; c < 3; ++c)
+					{
+						float value = std::min(std::max(linear[i * 4 + c], 0.f), 1.f);
+						rgba[i * 4 + c] = table[int(value * 4095.f + 0.5f)];
+					}
+
+					rgba[i * 4 + 3] = u8(std::min(std::max(linear[i * 4 + 3], 0.f), 1.f) * 255.f + 0.5f);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,205 @@
+#include <rfe/graphics/text_layout.h>
+#include <cmath>
+
+namespace rfe
+{
+	namespace graphics
+	{
+		text_layout::text_layout(glyph_atlas &atlas, std::size_t capacity)
+			: m_atlas(atlas)
+			, m_capacity(capacity)
+		{
+		}
+
+		std::shared_ptr<text_run_t> text_layout::shape(const std::string &text, const font::face &face, int size, glyph_mode mode, int width, text_align align)
+		{
+			auto result = std::make_shared<text_run_t>();
+			auto metrics = m_atlas.line_metrics(face, size);
+			result->line_height = metrics.height;
+
+			//sdf metrics are in pixels of the reference size
+			float scale = mode == glyph_mode::sdf ? float(size) / glyph_atlas::sdf_size : 1.f;
+
+			auto &glyphs = result->glyphs;
+			std::vector<float> advances;
+			std::vector<std::size_t> line_ends;
+			std::vector<float> line_widths;
+
+			glyphs.reserve(text.length());
+			advances.reserve(text.length());
+
+			std::size_t line_first = 0;
+			//first glyph after the last space of the line, a wrapped line breaks there
+			std::size_t break_at = 0;
+			float x = 0.f;
+			u32 previous = 0;
+
+			auto end_line = [&](std::size_t last)
+			{
+				float line_width = 0.f;
+
+				//trailing spaces are not measured
+				for (std::size_t i = last; i > line_first; --i)
+				{
+					if (glyphs[i - 1].codepoint != ' ')
+					{
+						line_width = glyphs[i - 1].position.x() + advances[i - 1];
+						break;
+					}
+				}
+
+				line_ends.push_back(last);
+				line_widths.push_back(line_width);
+				line_first = last;
+				break_at = last;
+			};
+
+			for (std::size_t position = 0; position < text.length();)
+			{
+				u32 codepoint = font::decode_utf8(text, position);
+
+				if (codepoint == '\n')
+				{
+					end_line(glyphs.size());
+					x = 0.f;
+					previous = 0;
+					continue;
+				}
+
+				glyph_atlas::glyph_t info;
+				m_atlas.glyph(face, size, codepoint, info, mode);
+
+				if (previous)
+				{
+					x += m_atlas.kerning(face, size, previous, codepoint, mode) * scale;
+				}
+
+				float advance = info.advance.x() * scale;
+
+				if (width > 0 && codepoint != ' ' && glyphs.size() > line_first && x + advance > width)
+				{
+					//the whole word moves to the next line, unless it is the only one there
+					std::size_t first = break_at > line_first ? break_at : glyphs.size();
+					float shift = first < glyphs.size() ? glyphs[first].position.x() : x;
+
+					end_line(first);
+
+					for (std::size_t i = first; i < glyphs.size(); ++i)
+					{
+						glyphs[i].position.x(glyphs[i].position.x() - shift);
+					}
+
+					x -= shift;
+				}
+
+				glyphs.push_back({ codepoint, { x, 0.f } });
+				advances.push_back(advance);
+
+				x += advance;
+				previous = codepoint;
+
+				if (codepoint == ' ')
+				{
+					break_at = glyphs.size();
+				}
+			}
+
+			end_line(glyphs.size());
+
+			float max_width = 0.f;
+
+			for (float line_width : line_widths)
+			{
+				max_width = std::max(max_width, line_width);
+			}
+
+			std::size_t first = 0;
+
+			for (std::size_t line = 0; line < line_ends.size(); ++line)
+			{
+				float offset = 0.f;
+
+				switch (align)
+				{
+				case text_align::center: offset = std::floor((max_width - line_widths[line]) / 2.f); break;
+				case text_align::right: offset = max_width - line_widths[line]; break;
+				default: break;
+				}
+
+				float baseline = float(metrics.ascender + int(line) * metrics.height);
+
+				for (std::size_t i = first; i < line_ends[line]; ++i)
+				{
+					glyphs[i].position += point2f{ offset, baseline };
+				}
+
+				first = line_ends[line];
+			}
+
+			result->lines = line_ends.size();
+			result->size = { (int)std::ceil(max_width), int(result->lines) * metrics.height };
+			return result;
+		}
+
+		std::shared_ptr<const text_run_t> text_layout::layout(const std::string &text, const font::face &face, int size, glyph_mode mode, int width, text_align align)
+		{
+			key_t key{ std::hash<std::string>()(text), face.ft_face, size, mode, width, align };
+
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				auto found = m_index.find(key);
+
+				if (found != m_index.end() && found->second->text == text)
+				{
+					m_entries.splice(m_entries.begin(), m_entries, found->second);
+					++m_hits;
+					return found->second->run;
+				}
+
+				++m_misses;
+			}
+
+			//shaped unlocked, the atlas guards the face
+			std::shared_ptr<const text_run_t> run = shape(text, face, size, mode, width, align);
+
+			std::lock_guard<std::mutex> lock(m_mtx);
+			auto found = m_index.find(key);
+
+			if (found != m_index.end())
+			{
+				m_entries.erase(found->second);
+				m_index.erase(found);
+			}
+
+			m_entries.push_front({ key, text, run });
+			m_index.emplace(key, m_entries.begin());
+
+			while (m_entries.size() > m_capacity)
+			{
+				m_index.erase(m_entries.back().key);
+				m_entries.pop_back();
+			}
+
+			return run;
+		}
+
+		u64 text_layout::hits() const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_hits;
+		}
+
+		u64 text_layout::misses() const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_misses;
+		}
+
+		void text_layout::clear()
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_entries.clear();
+			m_index.clear();
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#include <rfe/loaders/dds.h>
+#include <rfe/core/mapped_file.h>
+#include <rfe/graphics/pixel_convert.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace rfe
+{
+	namespace loaders
+	{
+		namespace dds
+		{
+			static const std::size_t header_size = 128;
+			static const std::size_t dx10_header_size = 20;
+
+			static u32 read_u32(const u8 *data)
+			{
+				return u32(data[0]) | u32(data[1]) << 8 | u32(data[2]) << 16 | u32(data[3]) << 24;
+			}
+
+			static u32 fourcc(const char *code)
+			{
+				return read_u32((const u8*)code);
+			}
+
+			bool is_dds(const u8 *data, std::size_t size)
+			{
+				return size >= 4 && std::memcmp(data, "DDS ", 4) == 0;
+			}
+
+			std::shared_ptr<graphics::image> load(const u8 *data, std::size_t size)
+			{
+				if (!is_dds(data, size) || size < header_size || read_u32(data + 4) != 124)
+				{
+					throw std::runtime_error("dds: bad signature");
+				}
+
+				size2i image_size{ (int)read_u32(data + 16), (int)read_u32(data + 12) };
+				int levels = (read_u32(data + 8) & 0x20000) ? std::max<int>(read_u32(data + 28), 1) : 1;
+				u32 format_flags = read_u32(data + 80);
+				u32 format_code = read_u32(data + 84);
+				std::size_t offset = header_size;
+				bool swizzle = false;
+				graphics::pixels_type type;
+
+				//cube maps
+				if (read_u32(data + 112) & 0x200)
+				{
+					throw std::runtime_error("dds: unsupported texture dimension");
+				}
+
+				if (format_flags & 0x4)
+				{
+					if (format_code == fourcc("DXT1"))
+					{
+						type = graphics::pixels_type::bc1;
+					}
+					else if (format_code == fourcc("DXT5"))
+					{
+						type = graphics::pixels_type::bc3;
+					}
+					else if (format_code == fourcc("DX10") && size >= header_size + dx10_header_size)
+					{
+						offset += dx10_header_size;
+
+						if (read_u32(data + header_size + 12) > 1)
+						{
+							throw std::runtime_error("dds: unsupported texture dimension");
+						}
+
+						switch (read_u32(data + header_size))
+						{
+						case 28: case 29: type = graphics::pixels_type::rgba8; break;
+						case 71: case 72: type = graphics::pixels_type::bc1; break;
+						case 77: case 78: type = graphics::pixels_type::bc3; break;
+						case 98: case 99: type = graphics::pixels_type::bc7; break;
+						case 87: case 91: type = graphics::pixels_type::rgba8; swizzle = true; break;
+						default: throw std::runtime_error("dds: unsupported format");
+						}
+					}
+					else
+					{
+						throw std::runtime_error("dds: unsupported format");
+					}
+				}
+				else if ((format_flags & 0x40) && read_u32(data + 88) == 32)
+				{
+					//red in the low byte is rgba, in the third one bgra
+					type = graphics::pixels_type::rgba8;
+					swizzle = read_u32(data + 92) == 0x00ff0000;
+				}
+				else
+				{
+					throw std::runtime_error("dds: unsupported format");
+				}
+
+				levels = std::min(levels, graphics::image::full_chain(image_size));
+				graphics::image layout(nullptr, image_size, type, levels);
+
+				if (image_size.width() <= 0 || image_size.height() <= 0 || size - offset < layout.bytes())
+				{
+					throw std::runtime_error("dds: truncated data");
+				}
+
+				auto pixels = std::make_unique<char[]>(layout.bytes());
+				std::memcpy(pixels.get(), data + offset, layout.bytes());
+
+				if (swizzle)
+				{
+					graphics::convert::swizzle_rb((const u8*)pixels.get(), (u8*)pixels.get(), layout.bytes() / 4);
+				}
+
+				//dds stores the top row first
+				return std::make_shared<graphics::image>(std::move(pixels), image_size, type, levels, graphics::image_origin::top_left);
+			}
+
+			std::shared_ptr<graphics::image> load(const std::string &path)
+			{
+				mapped_file file;
+
+				if (!file.open(path))
+				{
+					throw std::runtime_error("dds: cannot open " + path);
+				}
+
+				return load(file.data(), file.size());
+			}
+		}
+	}
+}
@@ -0,0 +1,179 @@
+#include <rfe/loaders/image_loader.h>
+#include <rfe/loaders/png.h>
+#include <rfe/loaders/dds.h>
+#include <rfe/loaders/ktx.h>
+#include <rfe/core/mapped_file.h>
+#include <stdexcept>
+
+namespace rfe
+{
+	namespace loaders
+	{
+		//container picked by its signature, the extension is not looked at
+		static std::shared_ptr<graphics::image> decode(const u8 *data, std::size_t size)
+		{
+			if (dds::is_dds(data, size))
+			{
+				return dds::load(data, size);
+			}
+
+			if (ktx::is_ktx(data, size))
+			{
+				return ktx::load(data, size);
+			}
+
+			return png::load(data, size);
+		}
+
+		static std::shared_ptr<graphics::image> decode(const std::string &path)
+		{
+			mapped_file file;
+
+			if (!file.open(path))
+			{
+				throw std::runtime_error("image_loader: cannot open " + path);
+			}
+
+			return decode(file.data(), file.size());
+		}
+
+		image_loader::image_loader(std::size_t threads)
+			: m_workers(make_thread_pool_queue(threads))
+		{
+		}
+
+		image_future image_loader::request(const std::string &path, callback_t callback)
+		{
+			auto promise = std::make_shared<std::promise<std::shared_ptr<graphics::image>>>();
+			image_future result;
+
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				auto found = m_in_flight.find(path);
+
+				if (found != m_in_flight.end())
+				{
+					++m_deduplicated;
+
+					if (callback)
+					{
+						found->second.callbacks.push_back(std::move(callback));
+					}
+
+					return found->second.future;
+				}
+
+				result = promise->get_future();
+				auto &request_ = m_in_flight[path];
+				request_.future = result;
+
+				if (callback)
+				{
+					request_.callbacks.push_back(std::move(callback));
+				}
+			}
+
+			m_workers.invoke([=]
+			{
+				std::shared_ptr<graphics::image> image;
+				std::exception_ptr error;
+
+				try
+				{
+					image = decode(path);
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+
+				std::vector<callback_t> callbacks;
+
+				{
+					//later requests for the path decode it again
+					std::lock_guard<std::mutex> lock(m_mtx);
+					auto found = m_in_flight.find(path);
+					callbacks = std::move(found->second.callbacks);
+					m_in_flight.erase(found);
+				}
+
+				if (error)
+				{
+					promise->set_exception(error);
+				}
+				else
+				{
+					promise->set_value(image);
+				}
+
+				for (auto &callback_ : callbacks)
+				{
+					callback_(image);
+				}
+			}, std::launch::async);
+
+			return result;
+		}
+
+		image_future image_loader::load(const std::string &path)
+		{
+			return request(path, nullptr);
+		}
+
+		std::vector<image_future> image_loader::load(const std::vector<std::string> &paths)
+		{
+			std::vector<image_future> result;
+			result.reserve(paths.size());
+
+			for (auto &path : paths)
+			{
+				result.push_back(request(path, nullptr));
+			}
+
+			return result;
+		}
+
+		image_future image_loader::load(std::vector<u8> buffer)
+		{
+			auto promise = std::make_shared<std::promise<std::shared_ptr<graphics::image>>>();
+			auto data = std::make_shared<std::vector<u8>>(std::move(buffer));
+			image_future result = promise->get_future();
+
+			m_workers.invoke([=]
+			{
+				try
+				{
+					promise->set_value(decode(data->data(), data->size()));
+				}
+				catch (...)
+				{
+					promise->set_exception(std::current_exception());
+				}
+			}, std::launch::async);
+
+			return result;
+		}
+
+		void image_loader::load(const std::string &path, callback_t callback)
+		{
+			request(path, std::move(callback));
+		}
+
+		u64 image_loader::deduplicated()
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_deduplicated;
+		}
+
+		void image_loader::wait()
+		{
+			m_workers.wait();
+		}
+
+		image_loader& default_image_loader()
+		{
+			static image_loader instance;
+			return instance;
+		}
+	}
+}
@@ -0,0 +1,159 @@
+#include <rfe/loaders/ktx.h>
+#include <rfe/core/mapped_file.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace rfe
+{
+	namespace loaders
+	{
+		namespace ktx
+		{
+			static const u8 identifier[12] = { 0xab, 'K', 'T', 'X', ' ', '1', '1', 0xbb, '\r', '\n', 0x1a, '\n' };
+			static const std::size_t header_size = 64;
+
+			bool is_ktx(const u8 *data, std::size_t size)
+			{
+				return size >= sizeof(identifier) && std::memcmp(data, identifier, sizeof(identifier)) == 0;
+			}
+
+			std::shared_ptr<graphics::image> load(const u8 *data, std::size_t size)
+			{
+				if (!is_ktx(data, size) || size < header_size)
+				{
+					throw std::runtime_error("ktx: bad signature");
+				}
+
+				//big endian files start their endianness word with 0x04
+				bool swap = data[12] == 0x04;
+
+				auto read_u32 = [&](std::size_t offset)
+				{
+					const u8 *value = data + offset;
+					return swap ? u32(value[3]) | u32(value[2]) << 8 | u32(value[1]) << 16 | u32(value[0]) << 24 :
+						u32(value[0]) | u32(value[1]) << 8 | u32(value[2]) << 16 | u32(value[3]) << 24;
+				};
+
+				u32 internal_format = read_u32(28);
+				size2i image_size{ (int)read_u32(36), (int)read_u32(40) };
+				int levels = std::max<int>(read_u32(56), 1);
+				graphics::pixels_type type;
+
+				if (read_u32(44) > 1 || read_u32(48) > 1 || read_u32(52) > 1)
+				{
+					throw std::runtime_error("ktx: unsupported texture dimension");
+				}
+
+				switch (internal_format)
+				{
+				case 0x83f0: case 0x83f1: case 0x8c4c: case 0x8c4d: type = graphics::pixels_type::bc1; break;
+				case 0x83f3: case 0x8c4f: type = graphics::pixels_type::bc3; break;
+				case 0x8e8c: case 0x8e8d: type = graphics::pixels_type::bc7; break;
+				case 0x9274: case 0x9275: type = graphics::pixels_type::etc2_rgb8; break;
+				case 0x9278: case 0x9279: type = graphics::pixels_type::etc2_rgba8; break;
+				case 0x8058: case 0x8c43: case 0x1908: type = graphics::pixels_type::rgba8; break;
+				case 0x8051: case 0x8c41: case 0x1907: type = graphics::pixels_type::rgb8; break;
+				default: throw std::runtime_error("ktx: unsupported format");
+				}
+
+				levels = std::min(levels, graphics::image::full_chain(image_size));
+				graphics::image layout(nullptr, image_size, type, levels);
+
+				if (image_size.width() <= 0 || image_size.height() <= 0)
+				{
+					throw std::runtime_error("ktx: bad size");
+				}
+
+				std::size_t offset = header_size + read_u32(60);
+				graphics::image_origin origin = graphics::image_origin::bottom_left;
+
+				if (offset > size)
+				{
+					throw std::runtime_error("ktx: truncated data");
+				}
+
+				//key and value pairs, only the orientation is used. t going down is the top row first
+				for (std::size_t pair = header_size; pair + 4 <= offset;)
+				{
+					std::size_t pair_size = read_u32(pair);
+
+					if (pair_size > offset - pair - 4)
+					{
+						break;
+					}
+
+					std::string text((const char*)data + pair + 4, pair_size);
+
+					if (text.compare(0, 15, std::string("KTXorientation\0", 15)) == 0 && text.find("T=d") != std::string::npos)
+					{
+						origin = graphics::image_origin::top_left;
+					}
+
+					pair += 4 + ((pair_size + 3) & ~std::size_t(3));
+				}
+
+				auto pixels = std::make_unique<char[]>(layout.bytes());
+
+				for (int level = 0; level < levels; ++level)
+				{
+					size2i level_size = layout.level_size(level);
+					std::size_t level_bytes = graphics::pixels_bytes(type, level_size);
+
+					if (offset + 4 > size)
+					{
+						throw std::runtime_error("ktx: truncated data");
+					}
+
+					std::size_t image_bytes = read_u32(offset);
+					offset += 4;
+
+					if (offset + image_bytes > size || image_bytes < level_bytes)
+					{
+						throw std::runtime_error("ktx: truncated data");
+					}
+
+					char *to = pixels.get() + layout.level_offset(level);
+
+					if (image_bytes == level_bytes || graphics::is_compressed(type))
+					{
+						std::memcpy(to, data + offset, level_bytes);
+					}
+					else
+					{
+						//uncompressed rows are padded to 4 bytes
+						std::size_t row_bytes = std::size_t(level_size.width()) * graphics::block_bytes(type);
+						std::size_t pitch = (row_bytes + 3) & ~std::size_t(3);
+
+						if (image_bytes < pitch * (level_size.height() - 1) + row_bytes)
+						{
+							throw std::runtime_error("ktx: truncated data");
+						}
+
+						for (int row = 0; row < level_size.height(); ++row)
+						{
+							std::memcpy(to + row * row_bytes, data + offset + row * pitch, row_bytes);
+						}
+					}
+
+					offset += (image_bytes + 3) & ~std::size_t(3);
+				}
+
+				return std::make_shared<graphics::image>(std::move(pixels), image_size, type, levels, origin);
+			}
+
+			std::shared_ptr<graphics::image> load(const std::string &path)
+			{
+				mapped_file file;
+
+				if (!file.open(path))
+				{
+					throw std::runtime_error("ktx: cannot open " + path);
+				}
+
+				return load(file.data(), file.size());
+			}
+		}
+	}
+}
@@ -1,6 +1,12 @@
 #include <rfe/loaders/png.h>
+#include <rfe/core/mapped_file.h>
+#include <rfe/graphics/pixel_convert.h>
 #include <png.h>
-#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <vector>
 
 namespace rfe
 {
@@ -8,85 +14,289 @@ namespace rfe
 	{
 		namespace png
 		{
-			std::shared_ptr<graphics::image> load(std::istream& stream)
+			void image_sink::begin(size2i size, graphics::pixels_type type, std::size_t pitch)
 			{
-				png_byte header[8];
-				stream.read((char*)header, sizeof(header));
+				m_pixels = std::make_unique<char[]>(pitch * size.height());
+				m_size = size;
+				m_type = type;
+				m_pitch = pitch;
+			}
 
-				if (png_sig_cmp(header, 0, 8))
+			u8* image_sink::target(int first, int count)
+			{
+				return (u8*)m_pixels.get() + std::size_t(first) * m_pitch;
+			}
+
+			void image_sink::rows(int first, int count, const u8 *data)
+			{
+				//decoded in place unless the rows came from elsewhere
+				if (data == target(first, count))
 				{
-					//TODO
-					throw;
+					return;
 				}
 
+				std::memcpy(m_pixels.get() + std::size_t(first) * m_pitch, data, std::size_t(count) * m_pitch);
+			}
+
+			std::shared_ptr<graphics::image> image_sink::image()
+			{
+				return std::make_shared<graphics::image>(std::move(m_pixels), m_size, m_type, 1, graphics::image_origin::top_left);
+			}
+
+			//memory left to read
+			struct memory_source
+			{
+				const u8 *data;
+				std::size_t size;
+			};
+
+			static void decode(png_rw_ptr read, void *source, row_sink &sink, int rows_per_chunk)
+			{
 				std::unique_ptr<png_struct, void(*)(png_structp)> png_ptr(png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr), [](png_structp png_ptr)
 				{
 					png_destroy_read_struct(&png_ptr, nullptr, nullptr);
 				});
 
-
-				//TODO: safe cleanup
 				png_infop info_ptr = png_create_info_struct(png_ptr.get());
 
+				std::unique_ptr<png_info, std::function<void(png_infop)>> info_guard(info_ptr, [&](png_infop info)
+				{
+					png_destroy_info_struct(png_ptr.get(), &info);
+				});
+
+				//everything the decode loop touches lives before the jump point, a longjmp skips no destructor
+				std::vector<u8> chunk;
+				std::vector<u8> raw;
+				std::vector<u8> narrowed;
+				std::vector<u8> palette;
+				rows_per_chunk = std::max(rows_per_chunk, 1);
+
 				if (setjmp(png_jmpbuf(png_ptr.get())))
 				{
-					throw;
+					throw std::runtime_error("png: corrupted data");
 				}
 
-				png_set_read_fn(png_ptr.get(), &static_cast<std::istream&>(stream), [](png_structp png_ptr, png_bytep data, png_size_t size)
+				png_set_read_fn(png_ptr.get(), source, read);
+
+				png_byte header[8];
+				read(png_ptr.get(), header, sizeof(header));
+
+				if (png_sig_cmp(header, 0, 8))
 				{
-					std::istream &stream = *((std::istream*)png_get_io_ptr(png_ptr));
-					stream.read((char*)data, size);
-				});
+					throw std::runtime_error("png: bad signature");
+				}
 
 				png_set_sig_bytes(png_ptr.get(), 8);
 				png_read_info(png_ptr.get(), info_ptr);
 
 				png_uint_32 width, height;
-				int bit_depth, color_type;
+				int bit_depth, color_type, interlace_type;
 
-				png_get_IHDR(png_ptr.get(), info_ptr, &width, &height, &bit_depth, &color_type, nullptr, nullptr, nullptr);
+				png_get_IHDR(png_ptr.get(), info_ptr, &width, &height, &bit_depth, &color_type, &interlace_type, nullptr, nullptr);
 
+				//transparent color keys are rare, libpng expands those images
+				if (color_type != PNG_COLOR_TYPE_PALETTE && png_get_valid(png_ptr.get(), info_ptr, PNG_INFO_tRNS))
+				{
+					png_set_expand(png_ptr.get());
+					png_set_tRNS_to_alpha(png_ptr.get());
+					png_set_gray_to_rgb(png_ptr.get());
+					png_set_strip_16(png_ptr.get());
+				}
+
+				int passes = png_set_interlace_handling(png_ptr.get());
 				png_read_update_info(png_ptr.get(), info_ptr);
 
-				if (setjmp(png_jmpbuf(png_ptr.get())))
+				color_type = png_get_color_type(png_ptr.get(), info_ptr);
+				bit_depth = png_get_bit_depth(png_ptr.get(), info_ptr);
+
+				graphics::pixels_type type = color_type == PNG_COLOR_TYPE_RGB ? graphics::pixels_type::rgb8 : graphics::pixels_type::rgba8;
+
+				if (color_type == PNG_COLOR_TYPE_PALETTE)
+				{
+					png_colorp colors = nullptr;
+					int colors_count = 0;
+					png_bytep alpha = nullptr;
+					int alpha_count = 0;
+					png_get_PLTE(png_ptr.get(), info_ptr, &colors, &colors_count);
+					png_get_tRNS(png_ptr.get(), info_ptr, &alpha, &alpha_count, nullptr);
+
+					//indices past the palette are opaque black
+					palette.resize(256 * 4);
+
+					for (int i = 0; i < 256; ++i)
+					{
+						palette[i * 4] = i < colors_count ? colors[i].red : 0;
+						palette[i * 4 + 1] = i < colors_count ? colors[i].green : 0;
+						palette[i * 4 + 2] = i < colors_count ? colors[i].blue : 0;
+						palette[i * 4 + 3] = i < alpha_count ? alpha[i] : 0xff;
+					}
+				}
+
+				png_size_t raw_pitch = png_get_rowbytes(png_ptr.get(), info_ptr);
+				std::size_t samples = std::size_t(width) * png_get_channels(png_ptr.get(), info_ptr);
+				std::size_t pitch = std::size_t(width) * (type == graphics::pixels_type::rgb8 ? 3 : 4);
+				bool direct = bit_depth == 8 && (color_type == PNG_COLOR_TYPE_RGB || color_type == PNG_COLOR_TYPE_RGB_ALPHA);
+
+				if (bit_depth == 16)
 				{
-					throw;
+					narrowed.resize(samples);
 				}
 
-				png_size_t pitch = png_get_rowbytes(png_ptr.get(), info_ptr);
+				//a row as libpng stores it to rgb8 or rgba8
+				auto convert_row = [&](const u8 *from, u8 *to)
+				{
+					if (bit_depth == 16)
+					{
+						graphics::convert::narrow_16(from, narrowed.data(), samples);
+						from = narrowed.data();
+					}
 
-				std::unique_ptr<char[]> pixels = std::make_unique<char[]>(pitch * height);
+					switch (color_type)
+					{
+					case PNG_COLOR_TYPE_PALETTE: graphics::convert::expand_palette(from, bit_depth, palette.data(), to, width); break;
+					case PNG_COLOR_TYPE_GRAY: graphics::convert::expand_gray(from, std::min(bit_depth, 8), to, width); break;
+					case PNG_COLOR_TYPE_GRAY_ALPHA: graphics::convert::expand_gray_alpha(from, to, width); break;
+					default: std::memcpy(to, from, pitch); break;
+					}
+				};
 
-				std::unique_ptr<png_bytep[]> rows = std::make_unique<png_bytep[]>(height);
+				sink.begin(size2i{ (int)width, (int)height }, type, pitch);
 
-				for (png_uint_32 i = 0; i < height; i++)
+				if (passes > 1)
 				{
-					rows[height - 1 - i] = (png_byte*)pixels.get() + i * pitch;
+					//every pass touches every row, nothing is final before the last one
+					raw.resize(raw_pitch * height);
+
+					for (int pass = 0; pass < passes; ++pass)
+					{
+						for (png_uint_32 y = 0; y < height; ++y)
+						{
+							png_read_row(png_ptr.get(), raw.data() + y * raw_pitch, nullptr);
+						}
+					}
+
+					if (!direct && !sink.target(0, 0))
+					{
+						chunk.resize(pitch * rows_per_chunk);
+					}
+
+					for (png_uint_32 first = 0; first < height; first += rows_per_chunk)
+					{
+						int count = (int)std::min<png_uint_32>(rows_per_chunk, height - first);
+
+						if (direct)
+						{
+							sink.rows((int)first, count, raw.data() + first * raw_pitch);
+							continue;
+						}
+
+						u8 *to = sink.target((int)first, count);
+						to = to ? to : chunk.data();
+
+						for (int i = 0; i < count; ++i)
+						{
+							convert_row(raw.data() + (first + i) * raw_pitch, to + i * pitch);
+						}
+
+						sink.rows((int)first, count, to);
+					}
 				}
+				else
+				{
+					chunk.resize(sink.target(0, 0) ? 0 : pitch * rows_per_chunk);
+					raw.resize(direct ? 0 : raw_pitch);
 
-				png_read_image(png_ptr.get(), rows.get());
+					for (png_uint_32 first = 0; first < height; first += rows_per_chunk)
+					{
+						int count = (int)std::min<png_uint_32>(rows_per_chunk, height - first);
+						u8 *to = sink.target((int)first, count);
+						to = to ? to : chunk.data();
 
-				graphics::pixels_type type;
+						for (int i = 0; i < count; ++i)
+						{
+							if (direct)
+							{
+								png_read_row(png_ptr.get(), to + i * pitch, nullptr);
+							}
+							else
+							{
+								png_read_row(png_ptr.get(), raw.data(), nullptr);
+								convert_row(raw.data(), to + i * pitch);
+							}
+						}
 
-				switch (color_type)
+						sink.rows((int)first, count, to);
+					}
+				}
+
+				png_read_end(png_ptr.get(), nullptr);
+				sink.end();
+			}
+
+			void decode(std::istream& stream, row_sink &sink, int rows_per_chunk)
+			{
+				decode([](png_structp png_ptr, png_bytep data, png_size_t size)
 				{
-				case PNG_COLOR_TYPE_RGB: type = graphics::pixels_type::rgb8; break;
-				case PNG_COLOR_TYPE_RGB_ALPHA: type = graphics::pixels_type::rgba8; break;
-				default:
-					//todo
-					throw;
+					std::istream &stream = *((std::istream*)png_get_io_ptr(png_ptr));
+
+					if (!stream.read((char*)data, size))
+					{
+						png_error(png_ptr, "unexpected end of data");
+					}
+				}, &stream, sink, rows_per_chunk);
+			}
+
+			void decode(const u8 *data, std::size_t size, row_sink &sink, int rows_per_chunk)
+			{
+				//libpng pulls the compressed stream from the memory as it inflates, no read ahead copy is made
+				memory_source source{ data, size };
+
+				decode([](png_structp png_ptr, png_bytep data, png_size_t size)
+				{
+					memory_source &source = *((memory_source*)png_get_io_ptr(png_ptr));
+
+					if (source.size < size)
+					{
+						png_error(png_ptr, "unexpected end of data");
+					}
+
+					std::memcpy(data, source.data, size);
+					source.data += size;
+					source.size -= size;
+				}, &source, sink, rows_per_chunk);
+			}
+
+			void decode(const std::string &path, row_sink &sink, int rows_per_chunk)
+			{
+				mapped_file file;
+
+				if (!file.open(path))
+				{
+					throw std::runtime_error("png: cannot open " + path);
 				}
 
-				png_destroy_info_struct(png_ptr.get(), &info_ptr);
+				decode(file.data(), file.size(), sink, rows_per_chunk);
+			}
 
-				return std::make_shared<graphics::image>(std::move(pixels), size2i{ (int)width, (int)height }, type);
+			std::shared_ptr<graphics::image> load(std::istream& stream)
+			{
+				image_sink sink;
+				decode(stream, sink, 64);
+				return sink.image();
 			}
 
 			std::shared_ptr<graphics::image> load(const std::string &path)
 			{
-				std::ifstream stream(path, std::ios::binary);
-				return load(stream);
+				image_sink sink;
+				decode(path, sink, 64);
+				return sink.image();
+			}
+
+			std::shared_ptr<graphics::image> load(const u8 *data, std::size_t size)
+			{
+				image_sink sink;
+				decode(data, size, sink, 64);
+				return sink.image();
 			}
 		}
 	}
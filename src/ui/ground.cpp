@@ -28,17 +28,37 @@ namespace rfe
 			};
 		}
 
+		void ground::load(const std::string &path, loaders::image_loader &loader)
+		{
+			std::weak_ptr<widget> weak_this = shared_ptr();
+
+			loader.load(path, [=](std::shared_ptr<graphics::image> image)
+			{
+				auto this_ = weak_this.lock();
+
+				if (image && this_)
+				{
+					texture = graphics::texture(image);
+				}
+			});
+		}
+
 		void ground::make_color_drawable(const color4f &value)
 		{
 			auto color_ = color();
 
+			auto dc = m_draw_context();
+
 			if (color_.a() <= 0.01f)
 			{
-				color_drawable.reset();
+				if (dc)
+				{
+					dc->release(color_drawable);
+				}
+
 				return;
 			}
 
-			auto dc = m_draw_context();
 			if (!dc)
 			{
 				return;
@@ -55,14 +75,18 @@ namespace rfe
 
 		void ground::make_texture_drawable(const graphics::texture& tex)
 		{
+			auto dc = m_draw_context();
+
 			if (tex.empty())
 			{
-				texture_drawable.reset();
+				if (dc)
+				{
+					dc->release(texture_drawable);
+				}
+
 				return;
 			}
 
-			auto dc = m_draw_context();
-
 			if (!dc)
 			{
 				return;
@@ -87,12 +111,12 @@ namespace rfe
 			{
 				if (auto drawable = color_drawable.lock())
 				{
-					drawable->draw(clip, matrix);
+					drawable->draw(clip(), matrix());
 				}
 
 				if (auto drawable = texture_drawable.lock())
 				{
-					drawable->draw(clip, matrix);
+					drawable->draw(clip(), matrix());
 				}
 			}
 		}
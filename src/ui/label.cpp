@@ -17,41 +17,51 @@ namespace rfe
 
 			text.onchanged += [=](ignore, ignore)
 			{
-				m_text_invalidated = true;
+				measure();
 				return event_result::skip;
 			};
 
 			font.onchanged += [=](ignore, ignore)
 			{
 				m_font_invalidated = true;
+				measure();
 				return event_result::skip;
 			};
 
-			size.onchanged += [=](ignore, ignore)
+			wrap_width.onchanged += [=](ignore, ignore)
 			{
-				m_matrix_invalidated = true;
+				measure();
 				return event_result::skip;
 			};
 
-			position.onchanged += [=](ignore, ignore)
+			align.onchanged += [=](ignore, ignore)
 			{
-				m_matrix_invalidated = true;
+				measure();
+				return event_result::skip;
+			};
+
+			m_draw_context.onchanged += [=](ignore, ignore)
+			{
+				measure();
 				return event_result::skip;
 			};
 		}
 
-		void label::set_parent(std::shared_ptr<widget> parent)
+		void label::measure()
 		{
-			widget::set_parent(parent);
+			m_text_invalidated = true;
+
+			auto dc_ = dc();
 
-			if (m_parent)
+			if (!dc_)
 			{
-				parent_event_binder(m_parent->onrefresh) += [=]
-				{
-					m_matrix_invalidated = true;
-					return event_result::skip;
-				};
+				return;
 			}
+
+			auto font_ = font();
+			std::string text_ = text();
+
+			size = text_.empty() ? size2i{ 0, font_.size } : dc_->layout_text(font_, text_, wrap_width(), align())->size;
 		}
 
 		void label::dodraw()
@@ -63,38 +73,41 @@ namespace rfe
 				return;
 			}
 
-			if (m_text_invalidated || m_font_invalidated || m_text_drawable.expired())
+			if (m_font_invalidated || m_text_drawable.expired())
 			{
 				auto font_ = font();
+				m_text_drawable = cache.data[font_];
 
 				if (m_text_drawable.expired())
 				{
-					m_text_drawable = cache.data[font_];
-
-					if (m_text_drawable.expired())
-					{
-						dc()->prepare(shared_ptr(), m_text_drawable, font_.face.set_pixel_sizes(font_.size));
-					}
+					dc()->prepare(shared_ptr(), m_text_drawable, font_.face.set_pixel_sizes(font_.size));
+					cache.data[font_] = m_text_drawable;
 				}
 
-				size = size2i{ (int)text().length() * font_.size / 2, font_.size };
 				m_font_invalidated = false;
+				m_text_invalidated = true;
 			}
 
-			if (m_matrix_invalidated)
+			if (parent())
 			{
-				//auto window_size = top_widget()->size();
+				std::shared_ptr<const widget> top_widget;
+				point2i absolute_positon = local_to_absolute_point({}, &top_widget);
+				size2i top_size = top_widget->size();
 
-				if (auto parent_ = parent())
+				//the store only holds the unit quad matrix, rebuild the text one when the label moved
+				if (absolute_positon != m_matrix_position || top_size != m_matrix_window_size)
 				{
-					point2i absolute_positon = position();
-					while (parent_->parent())
-					{
-						absolute_positon += std::static_pointer_cast<widget>(parent_)->position();
-						parent_ = parent_->parent();
-					}
+					m_matrix_position = absolute_positon;
+					m_matrix_window_size = top_size;
+					m_matrix_invalidated = true;
+				}
+			}
 
-					auto window_size = std::static_pointer_cast<widget>(parent_)->size();
+			if (m_matrix_invalidated)
+			{
+				if (parent())
+				{
+					auto window_size = m_matrix_window_size;
 					size2d scale = window_size;
 					point2d offset{};
 
@@ -116,7 +129,7 @@ namespace rfe
 					scale /= window_size;
 					offset /= window_size;
 
-					point2d translate = (point2d(absolute_positon) + point2d{ 0., (double)font().size }) * 2. / window_size - point2d{ 1., 1. };
+					point2d translate = point2d(m_matrix_position) * 2. / window_size - point2d{ 1., 1. };
 					m_matrix = mtx::scale_offset((vector3f)scale, { (float)translate.x(), (float)-translate.y(), 0 });
 					m_matrix_invalidated = false;
 				}
@@ -124,9 +137,10 @@ namespace rfe
 
 			if (auto drawable = m_text_drawable.lock())
 			{
-				if (m_text_invalidated)
+				if (m_text_invalidated || drawable->outdated(m_text_coords))
 				{
-					m_text_coords = drawable->prepare(text_);
+					//same run measure() laid out, taken from the cache
+					m_text_coords = drawable->prepare(*drawable->layout(text_, wrap_width(), align()));
 					m_text_invalidated = false;
 				}
 
@@ -4,6 +4,72 @@ namespace rfe
 {
 	namespace ui
 	{
+		void list_row_index::uniform(std::size_t count, int row_height)
+		{
+			m_count = count;
+			m_row_height = row_height;
+			m_offsets.clear();
+		}
+
+		void list_row_index::variable(std::size_t count, const std::function<int(std::size_t)> &row_height)
+		{
+			m_count = count;
+			m_row_height = 0;
+			m_offsets.resize(count + 1);
+			m_offsets[0] = 0;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				m_offsets[i + 1] = m_offsets[i] + std::max(row_height(i), 0);
+			}
+		}
+
+		std::size_t list_row_index::count() const
+		{
+			return m_count;
+		}
+
+		int list_row_index::offset(std::size_t index) const
+		{
+			if (m_offsets.empty())
+			{
+				return (int)index * m_row_height;
+			}
+
+			return m_offsets[index];
+		}
+
+		int list_row_index::height(std::size_t index) const
+		{
+			if (m_offsets.empty())
+			{
+				return m_row_height;
+			}
+
+			return m_offsets[index + 1] - m_offsets[index];
+		}
+
+		int list_row_index::total_height() const
+		{
+			return offset(m_count);
+		}
+
+		std::size_t list_row_index::index_at(int offset) const
+		{
+			if (offset < 0)
+			{
+				return 0;
+			}
+
+			if (m_offsets.empty())
+			{
+				return m_row_height > 0 ? std::min<std::size_t>(offset / m_row_height, m_count) : m_count;
+			}
+
+			auto it = std::upper_bound(m_offsets.begin(), m_offsets.end(), offset);
+			return std::min<std::size_t>(it - m_offsets.begin() - 1, m_count);
+		}
+
 		list::list() : scrollable{ this }
 		{
 			name = "list widget";
@@ -21,21 +87,283 @@ namespace rfe
 
 			background->onclick += [=](ignore)
 			{
-				for (auto& entry : m_entries)
+				clear_selection();
+			};
+
+			selection_mode.onchanged += [=](ignore, list_selection_mode mode)
+			{
+				if (mode == list_selection_mode::single && m_selected_entries.size() + m_selected_rows.size() > 1)
 				{
-					entry->unselect();
+					clear_selection();
 				}
 			};
 
 			onmotion += [=](point2i start_point, point2i current_point)
 			{
-				vertical_scroll = vertical_scroll() + (current_point.y() - start_point.y());
+				drag(start_point, current_point);
 			};
+
+			onmotion_end += [=](ignore)
+			{
+				fling();
+			};
+
+			//bound after the scrollable one, so it runs first. rows are placed at their content offsets and
+			//translated by the scrollable, entries are only rebound when the visible range changes
+			vertical_scroll.onchanged += [=](ignore, int new_value)
+			{
+				if (!is_virtual())
+				{
+					return event_result::skip;
+				}
+
+				int max_offset = std::max(0, m_rows.total_height() - height());
+				int value = -std::min(std::max(-new_value, 0), max_offset);
+
+				if (value != new_value)
+				{
+					vertical_scroll = value;
+					return event_result::handled;
+				}
+
+				update_rows();
+				return event_result::skip;
+			};
+
+			size.onchanged += [=](ignore, ignore)
+			{
+				if (is_virtual())
+				{
+					update_rows();
+				}
+			};
+
+			row_height.onchanged += [=](ignore, ignore)
+			{
+				if (is_virtual())
+				{
+					reload();
+				}
+			};
+
+			overscan.onchanged += [=](ignore, ignore)
+			{
+				if (is_virtual())
+				{
+					update_rows();
+				}
+			};
+		}
+
+		void list::source(list_source source_)
+		{
+			m_source = std::move(source_);
+			m_selected_rows.clear();
+			m_anchor_row = npos;
+			reload();
+		}
+
+		void list::reload()
+		{
+			std::size_t count = m_source.count ? m_source.count() : 0;
+
+			if (m_source.row_height)
+			{
+				m_rows.variable(count, m_source.row_height);
+			}
+			else
+			{
+				m_rows.uniform(count, row_height());
+			}
+
+			for (auto it = m_selected_rows.begin(); it != m_selected_rows.end();)
+			{
+				if (*it >= count)
+				{
+					it = m_selected_rows.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+
+			if (m_anchor_row != npos && m_anchor_row >= count)
+			{
+				m_anchor_row = npos;
+			}
+
+			int max_offset = std::max(0, m_rows.total_height() - height());
+
+			if (-vertical_scroll() > max_offset)
+			{
+				vertical_scroll = -max_offset;
+			}
+
+			update_rows(true);
+		}
+
+		bool list::is_virtual() const
+		{
+			return (bool)m_source.count;
+		}
+
+		size2i list::content_size() const
+		{
+			if (is_virtual())
+			{
+				return{ measured_size().width(), m_rows.total_height() };
+			}
+
+			return scrollable::content_size();
+		}
+
+		std::size_t list::row_of(const std::shared_ptr<list_entry> &entry) const
+		{
+			auto it = m_entry_rows.find(entry.get());
+
+			return it == m_entry_rows.end() ? npos : it->second;
+		}
+
+		std::shared_ptr<list_entry> list::bound_entry(std::size_t index) const
+		{
+			if (index < m_first_row || index - m_first_row >= m_virtual_rows.size())
+			{
+				return nullptr;
+			}
+
+			return m_virtual_rows[index - m_first_row].entry;
+		}
+
+		void list::scroll_to(std::size_t index)
+		{
+			if (!is_virtual() || index >= m_rows.count())
+			{
+				return;
+			}
+
+			int offset = -vertical_scroll();
+			int row_offset = m_rows.offset(index);
+			int row_bottom = row_offset + m_rows.height(index);
+
+			if (row_offset < offset)
+			{
+				vertical_scroll = -row_offset;
+			}
+			else if (row_bottom > offset + height())
+			{
+				vertical_scroll = -(row_bottom - height());
+			}
+		}
+
+		std::shared_ptr<list_entry> list::take_entry()
+		{
+			if (!m_free_entries.empty())
+			{
+				auto entry = std::move(m_free_entries.back());
+				m_free_entries.pop_back();
+				return entry;
+			}
+
+			auto entry = m_source.make_entry();
+			auto &binder = entry->event_binder;
+
+			binder(entry->onactivate) += [=]
+			{
+				onactivate(entry);
+			};
+
+			//the selection belongs to the row, entries only follow it while bound
+			binder(entry->selected.onchanged) += [=](ignore, bool selected)
+			{
+				std::size_t index = row_of(entry);
+
+				if (index == npos)
+				{
+					return;
+				}
+
+				if (selected)
+				{
+					select_row_entry(index, entry);
+				}
+				else
+				{
+					unselect_row_entry(index);
+				}
+			};
+
+			append_child(entry).fit(fit_type::never).expand_horizontal();
+			return entry;
+		}
+
+		void list::update_rows(bool rebind)
+		{
+			int viewport = height();
+			int max_offset = std::max(0, m_rows.total_height() - viewport);
+			int offset = std::min(std::max(-vertical_scroll(), 0), max_offset);
+			std::size_t count = m_rows.count();
+			std::size_t overscan_ = (std::size_t)std::max(0, overscan());
+
+			std::size_t first = m_rows.index_at(offset);
+			std::size_t last = viewport > 0 ? std::min(m_rows.index_at(offset + viewport - 1) + 1, count) : first;
+
+			first = first > overscan_ ? first - overscan_ : 0;
+			last = std::min(count, last + overscan_);
+
+			if (first > last)
+			{
+				first = last;
+			}
+
+			if (!rebind && first == m_first_row && last - first == m_virtual_rows.size())
+			{
+				return;
+			}
+
+			std::vector<virtual_row> rows(last - first);
+
+			//rows that left the range give their entries back
+			for (auto &row : m_virtual_rows)
+			{
+				if (!rebind && row.index >= first && row.index < last)
+				{
+					rows[row.index - first] = std::move(row);
+				}
+				else
+				{
+					m_entry_rows.erase(row.entry.get());
+					row.entry->hide();
+					m_free_entries.push_back(std::move(row.entry));
+				}
+			}
+
+			m_virtual_rows.clear();
+			m_first_row = first;
+
+			for (std::size_t index = first; index < last; ++index)
+			{
+				auto &row = rows[index - first];
+
+				if (!row.entry)
+				{
+					row.index = index;
+					row.entry = take_entry();
+					m_entry_rows[row.entry.get()] = index;
+					m_source.bind_entry(*row.entry, index);
+					row.entry->selected = m_selected_rows.count(index) != 0;
+					row.entry->sizer_flags().y(m_rows.offset(index)).height(m_rows.height(index));
+					row.entry->show();
+				}
+			}
+
+			m_virtual_rows = std::move(rows);
 		}
 
 		ui::sizer_flags& list::add_entry(std::shared_ptr<list_entry> widget)
 		{
 			m_entries.emplace_back(widget);
+			m_entry_index[widget.get()] = { std::prev(m_entries.end()), m_next_order++ };
 			auto &binder = m_entries.back()->event_binder;
 
 			binder(widget->onactivate) += [=]
@@ -47,38 +375,106 @@ namespace rfe
 			{
 				if (selected)
 				{
-					for (auto& entry : m_entries)
-					{
-						if (entry != widget)
-						{
-							entry->unselect();
-						}
-					}
-
-					onselection_change(widget);
+					entry_selected(widget);
 				}
 				else
 				{
-					onselection_change(nullptr);
+					entry_unselected(widget);
 				}
 			};
 
+			if (widget->selected())
+			{
+				entry_selected(widget);
+			}
+
 			return static_cast<ui::widget&>(*this) += widget;
 		}
 
 		bool list::remove_entry(std::shared_ptr<list_entry> widget)
 		{
-			for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+			auto it = m_entry_index.find(widget.get());
+
+			if (it == m_entry_index.end())
+			{
+				return false;
+			}
+
+			m_entries.erase(it->second.it);
+			m_entry_index.erase(it);
+			entry_unselected(widget);
+			widget->onremove();
+			return true;
+		}
+
+		void list::entry_selected(const std::shared_ptr<list_entry> &entry)
+		{
+			if (m_entry_index.find(entry.get()) == m_entry_index.end() || !m_selected_entries.insert(entry.get()).second)
+			{
+				return;
+			}
+
+			if (selection_mode() == list_selection_mode::single)
 			{
-				if (*it == widget)
+				//at most one entry was selected, it is dropped from the set before it reports back
+				for (auto previous : m_selected_entries)
 				{
-					widget->onremove();
-					m_entries.erase(it);
-					return true;
+					if (previous != entry.get())
+					{
+						m_selected_entries.erase(previous);
+						previous->unselect();
+						break;
+					}
 				}
 			}
 
-			return false;
+			onselection_change(entry);
+		}
+
+		void list::entry_unselected(const std::shared_ptr<list_entry> &entry)
+		{
+			if (m_selected_entries.erase(entry.get()) && m_selected_entries.empty())
+			{
+				onselection_change(nullptr);
+			}
+		}
+
+		void list::select_row_entry(std::size_t index, const std::shared_ptr<list_entry> &entry)
+		{
+			if (!m_selected_rows.insert(index).second)
+			{
+				return;
+			}
+
+			m_anchor_row = index;
+
+			if (selection_mode() == list_selection_mode::single)
+			{
+				for (auto previous : m_selected_rows)
+				{
+					if (previous != index)
+					{
+						m_selected_rows.erase(previous);
+
+						if (auto previous_entry = bound_entry(previous))
+						{
+							previous_entry->unselect();
+						}
+
+						break;
+					}
+				}
+			}
+
+			onselection_change(entry);
+		}
+
+		void list::unselect_row_entry(std::size_t index)
+		{
+			if (m_selected_rows.erase(index) && m_selected_rows.empty())
+			{
+				onselection_change(nullptr);
+			}
 		}
 
 		ui::sizer_flags& list::operator +=(std::shared_ptr<list_entry> widget)
@@ -93,7 +489,172 @@ namespace rfe
 
 		std::shared_ptr<list_entry> list::selection() const
 		{
-			return m_selection.lock();
+			auto entry = m_selection.lock();
+
+			if (!entry)
+			{
+				return nullptr;
+			}
+
+			if (is_virtual())
+			{
+				//a recycled entry may already show another row
+				std::size_t index = row_of(entry);
+				return index != npos && index == m_anchor_row && m_selected_rows.count(index) ? entry : nullptr;
+			}
+
+			return m_selected_entries.count(entry.get()) ? entry : nullptr;
+		}
+
+		std::vector<std::shared_ptr<list_entry>> list::selected_entries() const
+		{
+			std::vector<std::shared_ptr<list_entry>> result;
+			result.reserve(m_selected_entries.size());
+
+			for (auto entry : m_selected_entries)
+			{
+				result.push_back(*m_entry_index.at(entry).it);
+			}
+
+			return result;
+		}
+
+		void list::select_range(const std::shared_ptr<list_entry> &from, const std::shared_ptr<list_entry> &to)
+		{
+			auto from_it = m_entry_index.find(from.get());
+			auto to_it = m_entry_index.find(to.get());
+
+			if (from_it == m_entry_index.end() || to_it == m_entry_index.end())
+			{
+				return;
+			}
+
+			if (selection_mode() == list_selection_mode::single)
+			{
+				to->select();
+				return;
+			}
+
+			auto begin = from_it->second;
+			auto end = to_it->second;
+
+			if (begin.order > end.order)
+			{
+				std::swap(begin, end);
+			}
+
+			for (auto it = begin.it; ; ++it)
+			{
+				(*it)->select();
+
+				if (it == end.it)
+				{
+					break;
+				}
+			}
+		}
+
+		void list::clear_selection()
+		{
+			//the sets are emptied first, so entries reporting back find nothing to do
+			auto entries = std::move(m_selected_entries);
+			auto rows = std::move(m_selected_rows);
+			m_selected_entries.clear();
+			m_selected_rows.clear();
+			m_anchor_row = npos;
+
+			for (auto entry : entries)
+			{
+				entry->unselect();
+			}
+
+			for (auto index : rows)
+			{
+				if (auto entry = bound_entry(index))
+				{
+					entry->unselect();
+				}
+			}
+
+			if (!entries.empty() || !rows.empty())
+			{
+				onselection_change(nullptr);
+			}
+		}
+
+		void list::select_row(std::size_t index)
+		{
+			if (index >= m_rows.count())
+			{
+				return;
+			}
+
+			auto entry = bound_entry(index);
+			select_row_entry(index, entry);
+
+			if (entry)
+			{
+				entry->select();
+			}
+		}
+
+		void list::unselect_row(std::size_t index)
+		{
+			unselect_row_entry(index);
+
+			if (auto entry = bound_entry(index))
+			{
+				entry->unselect();
+			}
+		}
+
+		void list::select_rows(std::size_t first, std::size_t last)
+		{
+			if (first > last)
+			{
+				std::swap(first, last);
+			}
+
+			if (last >= m_rows.count())
+			{
+				return;
+			}
+
+			if (selection_mode() == list_selection_mode::single)
+			{
+				select_row(last);
+				return;
+			}
+
+			for (std::size_t index = first; index <= last; ++index)
+			{
+				m_selected_rows.insert(index);
+
+				if (auto entry = bound_entry(index))
+				{
+					entry->select();
+				}
+			}
+
+			m_anchor_row = last;
+			onselection_change(bound_entry(last));
+		}
+
+		bool list::row_selected(std::size_t index) const
+		{
+			return m_selected_rows.count(index) != 0;
+		}
+
+		std::size_t list::selected_row() const
+		{
+			return m_anchor_row != npos && m_selected_rows.count(m_anchor_row) ? m_anchor_row : npos;
+		}
+
+		std::vector<std::size_t> list::selected_rows() const
+		{
+			std::vector<std::size_t> result(m_selected_rows.begin(), m_selected_rows.end());
+			std::sort(result.begin(), result.end());
+			return result;
 		}
 	}
 }
@@ -43,6 +43,7 @@ namespace rfe
 				program_view texture_program{ 0 };
 				program_view texture_sector_program{ 0 };
 				program_view font_program{ 0 };
+				program_view font_sdf_program{ 0 };
 			}
 		}
 	}
@@ -129,10 +130,13 @@ namespace rfe
 				use();
 				graphics::opengl::init();
 
-				gl::glsl::color_program = std::move(gl::glsl::programs::color());
-				gl::glsl::texture_program = std::move(gl::glsl::programs::texture());
-				gl::glsl::texture_sector_program = std::move(gl::glsl::programs::texture_sector());
-				gl::glsl::font_program = std::move(gl::glsl::programs::font());
+				m_cache = cfg.cache_directory().empty() ? nullptr : std::make_shared<disk_cache>(cfg.cache_directory());
+
+				gl::glsl::color_program = std::move(gl::glsl::programs::color(m_cache.get()));
+				gl::glsl::texture_program = std::move(gl::glsl::programs::texture(m_cache.get()));
+				gl::glsl::texture_sector_program = std::move(gl::glsl::programs::texture_sector(m_cache.get()));
+				gl::glsl::font_program = std::move(gl::glsl::programs::font(m_cache.get()));
+				gl::glsl::font_sdf_program = std::move(gl::glsl::programs::font_sdf(m_cache.get()));
 
 				gl::texture font_texture(gl::texture::target::texture2D);
 				gl::vao font_vao;
@@ -164,6 +168,9 @@ namespace rfe
 				glXSwapBuffers(handle->display, handle->window);
 #endif
 				graphics::draw_context::present();
+
+				//copies issued now are drawn from the next frame on
+				m_uploader.process();
 			}
 
 			void draw_context::close()
@@ -178,6 +185,9 @@ namespace rfe
 					use();
 
 					m_drawables.clear();
+					m_released.clear();
+					m_glyph_textures.clear();
+					m_uploader.clear();
 
 					if (gl::glsl::color_program)
 						gl::glsl::color_program.remove();
@@ -187,6 +197,8 @@ namespace rfe
 						gl::glsl::texture_sector_program.remove();
 					if (gl::glsl::font_program)
 						gl::glsl::font_program.remove();
+					if (gl::glsl::font_sdf_program)
+						gl::glsl::font_sdf_program.remove();
 
 					if (m_font_texture_id)
 						gl::texture_view(gl::texture::target::texture2D, m_font_texture_id).remove();
@@ -235,19 +247,149 @@ namespace rfe
 
 			std::weak_ptr<graphics::drawable> draw_context::prepare(std::shared_ptr<void> parent, const graphics::model &model)
 			{
-				std::shared_ptr<drawable> result = std::shared_ptr<drawable>(parent, new drawable(model));
-				m_drawables.push_back(result);
+				auto result = std::make_shared<drawable>(model, m_texture_cache);
+				attach(parent, result);
 				return result;
 			}
 
 			std::weak_ptr<graphics::drawable_text> draw_context::prepare(std::shared_ptr<void> parent, const font::face &face)
 			{
-				std::shared_ptr<drawable_text> result = std::shared_ptr<drawable_text>(parent, new drawable_text(this, face));
-				m_drawables.push_back(result);
+				auto result = std::make_shared<drawable_text>(this, face);
+				attach(parent, result);
+				return result;
+			}
+
+			std::shared_ptr<const graphics::text_run_t> draw_context::layout_text(const font::info &font_, const std::string &text, int width, graphics::text_align align)
+			{
+				return m_text_layout.layout(text, font_.face, font_.size, text_mode, width, align);
+			}
+
+			u64 draw_context::face_hash(const font::face &face)
+			{
+				std::lock_guard<std::mutex> lock(m_face_hashes_mtx);
+				auto found = m_face_hashes.find(face.ft_face);
+
+				if (found != m_face_hashes.end())
+				{
+					return found->second;
+				}
+
+				std::string path = face.file_path();
+				u64 result = path.empty() ? 0 : disk_cache::file_hash(path);
+				m_face_hashes.emplace(face.ft_face, result);
+				return result;
+			}
+
+			void draw_context::prewarm_size(const font::face &face, int size, const std::vector<u32> &codepoints, graphics::glyph_mode mode, const std::function<void()> &done)
+			{
+				std::string key;
+
+				if (m_cache)
+				{
+					if (u64 font_hash = face_hash(face))
+					{
+						u64 characters_hash = disk_cache::hash(codepoints.data(), codepoints.size() * sizeof(u32));
+						key = disk_cache::key("glyphs", { font_hash, u64(size), u64(mode), characters_hash });
+
+						mapped_file file;
+
+						if (m_cache->load(key, file) && m_glyph_atlas.load(face, size, mode, file.data(), file.size()))
+						{
+							done();
+							return;
+						}
+					}
+				}
+
+				//small enough to spread a single size over every worker
+				const std::size_t chunk = 32;
+
+				auto remaining = std::make_shared<std::atomic<std::size_t>>((codepoints.size() + chunk - 1) / chunk);
+
+				for (std::size_t first = 0; first < codepoints.size(); first += chunk)
+				{
+					std::vector<u32> part(codepoints.begin() + first, codepoints.begin() + std::min(first + chunk, codepoints.size()));
+
+					m_font_workers.invoke([=]
+					{
+						m_glyph_atlas.prewarm(face, size, part, mode);
+
+						if (--*remaining != 0)
+						{
+							return;
+						}
+
+						if (!key.empty())
+						{
+							std::vector<u8> saved = m_glyph_atlas.save(face, size, mode);
+							m_cache->store(key, saved.data(), saved.size());
+						}
+
+						done();
+					}, std::launch::async);
+				}
+			}
+
+			std::shared_future<void> draw_context::prewarm(const font::face &face, const std::vector<int> &sizes, const std::string &characters)
+			{
+				std::vector<u32> codepoints;
+
+				if (characters.empty())
+				{
+					for (u32 codepoint = 0x20; codepoint < 0x7f; ++codepoint)
+					{
+						codepoints.push_back(codepoint);
+					}
+				}
+				else
+				{
+					for (std::size_t position = 0; position < characters.length();)
+					{
+						codepoints.push_back(font::decode_utf8(characters, position));
+					}
+				}
+
+				auto promise = std::make_shared<std::promise<void>>();
+				std::shared_future<void> result = promise->get_future();
+
+				if (sizes.empty() || codepoints.empty())
+				{
+					promise->set_value();
+					return result;
+				}
+
+				auto remaining = std::make_shared<std::atomic<std::size_t>>(sizes.size());
+				std::weak_ptr<draw_context> weak_this = weak_from_this();
+
+				for (int size : sizes)
+				{
+					prewarm_size(face, size, codepoints, text_mode, [=]
+					{
+						if (--*remaining != 0)
+						{
+							return;
+						}
+
+						//only the upload needs the gl context
+						thread.invoke([=]
+						{
+							if (auto this_ = weak_this.lock())
+							{
+								for (u32 page = 0; page < this_->m_glyph_atlas.page_count(); ++page)
+								{
+									this_->glyph_texture(page);
+								}
+							}
+
+							promise->set_value();
+						}, std::launch::async);
+					});
+				}
+
 				return result;
 			}
 
-			drawable::drawable(const graphics::model &m)
+			drawable::drawable(const graphics::model &m, texture_cache &textures)
 			{
 				__glcheck vao.create();
 				__glcheck vao.bind();
@@ -264,38 +406,25 @@ namespace rfe
 
 					std::cout << "WIP: draw texture" << std::endl;
 
-					for (std::size_t i = 0; i < m.points_count(); ++i)
-					{
-						buffer[i] = { texture.coord(i % texture.coords_count()), (point4f)m.point(i) };
-					}
+					m_texture = textures.acquire(texture);
+					texture_id = m_texture->id;
 
-					gpu_buffer.create(buffer.size() * sizeof(buffer[0]), buffer.data());
-
-					//TODO: destroy objects
-					const auto &image = texture.image();
-
-					if (!texture_id)
-					{
-						__glcheck glGenTextures(1, &texture_id);
-					}
+					//the texture has the rows in image memory order, the coords count v from the bottom
+					bool flip = m_texture->origin == graphics::image_origin::top_left;
 
-					__glcheck glBindTexture(GL_TEXTURE_2D, texture_id);
-					switch (image.type())
+					for (std::size_t i = 0; i < m.points_count(); ++i)
 					{
-					case graphics::pixels_type::rgb8:
-						__glcheck glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.size().width(), image.size().height(), 0, GL_RGB, GL_UNSIGNED_BYTE, texture.image().get());
-						break;
+						point2f coord = texture.coord(i % texture.coords_count());
 
-					case graphics::pixels_type::rgba8:
-						__glcheck glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.size().width(), image.size().height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, texture.image().get());
-						break;
+						if (flip)
+						{
+							coord = { coord.x(), 1.0f - coord.y() };
+						}
 
-					default:
-						throw;
+						buffer[i] = { coord, (point4f)m.point(i) };
 					}
 
-					__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-					__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+					gpu_buffer.create(buffer.size() * sizeof(buffer[0]), buffer.data());
 
 					program = &gl::glsl::texture_program;
 				}
@@ -349,126 +478,161 @@ namespace rfe
 				__glcheck gl::screen.draw_arrays(vao, draw_mode, draw_count);
 			}
 
-			drawable_text::drawable_text(draw_context *dc_, const font::face& face)
-				: dc(dc_)
+			gl::texture& draw_context::glyph_texture(u32 page)
 			{
-				__glcheck vao.create();
-				__glcheck vbo.create();
-				__glcheck texture.create();
-
-				FT_GlyphSlot g = ((FT_Face)face.ft_face)->glyph;
-
-				uint max_width = 0;
-				uint max_height = 0;
-
-				for (int i = 0; i < 256; i++)
+				if (page >= m_glyph_textures.size())
 				{
-					if (!face.load_char(std::nothrow, i))
-						continue;
-
-					max_width = std::max(max_width, g->bitmap.width);
-					max_height = std::max(max_height, g->bitmap.rows);
+					m_glyph_textures.resize(page + 1);
 				}
 
-				__glcheck vao.create();
-				__glcheck vbo.create();
-
-				size2i texture_size(16 * max_width, 16 * max_height);
-
-				__glcheck texture.create(gl::texture::target::texture2D);
-				__glcheck texture.pixel_unpack_settings().aligment(1);
-				__glcheck texture.config()
-					.filter(gl::min_filter::linear, gl::filter::linear)
-					.format(gl::texture::format::red)
-					.internal_format(gl::texture::internal_format::red)
-					.size({ texture_size.width(), texture_size.height() });
+				auto &entry = m_glyph_textures[page];
 
-				char_info.resize(256);
+				m_glyph_atlas.sync_page(page, [&](const graphics::glyph_atlas::page_t &page_, const coord2i &dirty)
+				{
+					if (!entry.texture.created())
+					{
+						__glcheck entry.texture.create(gl::texture::target::texture2D);
+						__glcheck entry.texture.pixel_unpack_settings().aligment(1);
+					}
 
-				__glcheck texture.bind();
+					__glcheck entry.texture.bind();
+					__glcheck gl::pixel_unpack_settings().aligment(1).row_length(page_.size.width()).apply();
 
-				for (int x = 0; x < 16; ++x)
-				{
-					for (int y = 0; y < 16; ++y)
+					if (entry.size != page_.size)
 					{
-						int index = x * 16 + y;
-						if (!face.load_char(std::nothrow, index))
-							continue;
+						//the page grew, its content is uploaded whole
+						__glcheck entry.texture.config()
+							.filter(gl::min_filter::linear, gl::filter::linear)
+							.format(gl::texture::format::red)
+							.internal_format(gl::texture::internal_format::red)
+							.size(page_.size)
+							.pixels(page_.pixels.data());
+
+						entry.size = page_.size;
+					}
+					else
+					{
+						__glcheck glTexSubImage2D(GL_TEXTURE_2D, 0, dirty.position.x(), dirty.position.y(), dirty.size.width(), dirty.size.height(),
+							GL_RED, GL_UNSIGNED_BYTE, page_.pixels.data() + std::size_t(dirty.position.y()) * page_.size.width() + dirty.position.x());
+					}
+
+					__glcheck gl::pixel_unpack_settings().apply();
+				});
 
-						point2i position(x * max_width, y * max_height);
-						size2i size(g->bitmap.width, g->bitmap.rows);
+				return entry.texture;
+			}
 
-						__glcheck glTexSubImage2D(GL_TEXTURE_2D, 0, position.x(), position.y(),
-							size.width(), size.height(), GL_RED, GL_UNSIGNED_BYTE, g->bitmap.buffer);
+			drawable_text::drawable_text(draw_context *dc_, const font::face& face)
+				: dc(dc_)
+				, m_face(face)
+				, m_size(face.pixel_size())
+				, m_mode(dc_->text_mode)
+			{
+				__glcheck vao.create();
+				__glcheck vbo.create();
+			}
 
-						char_info[index] =
-						{
-							area2f{ point2f(position) / texture_size, size2f(position + size) / texture_size },
-							coord2i{ { g->bitmap_left, g->bitmap_top }, { (int)g->bitmap.width, (int)g->bitmap.rows } },
-							point2i{ g->advance.x >> 6, g->advance.y >> 6 }
-						};
-					}
-				}
+			std::shared_ptr<const graphics::text_run_t> drawable_text::layout(const std::string &text, int width, graphics::text_align align)
+			{
+				return dc->text_layout().layout(text, m_face, m_size, m_mode, width, align);
 			}
 
-			graphics::text_coords_t drawable_text::prepare(const std::string &text)
+			graphics::text_coords_t drawable_text::prepare(const graphics::text_run_t &run)
 			{
 				auto window_size = dc->parent()->size();
-				float sx = 2.f / window_size.width();
-				float sy = 2.f / window_size.height();
+				float px = 2.f / window_size.width();
+				float py = 2.f / window_size.height();
+
+				auto &atlas = dc->glyph_atlas();
+				atlas.begin_use();
 
-				float x = 0.0;
-				float y = 0.0;
+				//sdf glyphs come at the reference size and are scaled down to ours
+				float glyph_scale = m_mode == graphics::glyph_mode::sdf ? float(m_size) / graphics::glyph_atlas::sdf_size : 1.f;
+				float sx = px * glyph_scale;
+				float sy = py * glyph_scale;
 
 				graphics::text_coords_t coords;
-				coords.reserve(text.length() * 6);
+				coords.chars.reserve(run.glyphs.size());
+				coords.pages.reserve(run.glyphs.size());
 
-				for (char c : text)
+				for (auto &glyph : run.glyphs)
 				{
-					auto &info = char_info[c];
-
-					float x2 = x + info.coord.position.x() * sx;
-					float y2 = -y - info.coord.position.y() * sy;
-					float w = info.coord.size.width() * sx;
-					float h = info.coord.size.height() * sy;
-
-					graphics::char_coords_t char_coords =
-					{ {
-						{ x2,     -y2    , info.tex_coord.p1.x(), info.tex_coord.p1.y() },
-						{ x2 + w, -y2    , info.tex_coord.p2.x(), info.tex_coord.p1.y() },
-						{ x2,     -y2 - h, info.tex_coord.p1.x(), info.tex_coord.p2.y() },
-
-						{ x2 + w, -y2    , info.tex_coord.p2.x(), info.tex_coord.p1.y() },
-						{ x2,     -y2 - h, info.tex_coord.p1.x(), info.tex_coord.p2.y() },
-						{ x2 + w, -y2 - h, info.tex_coord.p2.x(), info.tex_coord.p2.y() },
-					} };
-
-					coords.push_back(char_coords);
+					graphics::glyph_atlas::glyph_t info;
 
-					x += info.advance.x() * sx;
-					y += info.advance.y() * sy;
+					if (atlas.glyph(m_face, m_size, glyph.codepoint, info, m_mode))
+					{
+						//run positions grow downwards, clip space upwards
+						float x = glyph.position.x() * px + info.coord.position.x() * sx;
+						float y = -glyph.position.y() * py + info.coord.position.y() * sy;
+						float w = info.coord.size.width() * sx;
+						float h = info.coord.size.height() * sy;
+
+						//texture coords are atlas pixels, normalized by the shader
+						point2f p1 = (point2f)info.atlas_coord.position;
+						point2f p2 = (point2f)(info.atlas_coord.position + info.atlas_coord.size);
+
+						graphics::char_coords_t char_coords =
+						{ {
+							{ x,     y    , p1.x(), p1.y() },
+							{ x + w, y    , p2.x(), p1.y() },
+							{ x,     y - h, p1.x(), p2.y() },
+
+							{ x + w, y    , p2.x(), p1.y() },
+							{ x,     y - h, p1.x(), p2.y() },
+							{ x + w, y - h, p2.x(), p2.y() },
+						} };
+
+						coords.chars.push_back(char_coords);
+						coords.pages.push_back(info.page);
+					}
 				}
 
+				coords.evictions = atlas.evictions();
 				return coords;
 			}
 
+			bool drawable_text::outdated(const graphics::text_coords_t &coords) const
+			{
+				return coords.evictions != dc->glyph_atlas().evictions();
+			}
+
 			void drawable_text::draw(const graphics::text_coords_t &coords, const color4f &color, vector4f clip, const matrix4f& matrix_)
 			{
-				auto &program = gl::glsl::font_program;
+				if (coords.chars.empty())
+				{
+					return;
+				}
+
+				auto &program = m_mode == graphics::glyph_mode::sdf ? gl::glsl::font_sdf_program : gl::glsl::font_program;
+				const GLsizei vertices_per_char = GLsizei(sizeof(graphics::char_coords_t) / sizeof(coords.chars[0][0]));
 
 				__glcheck vao.bind();
-				__glcheck vbo.data(coords.size() * sizeof(graphics::char_coords_t), coords.data());
+				__glcheck vbo.data(coords.chars.size() * sizeof(graphics::char_coords_t), coords.chars.data());
 				__glcheck vao.array_buffer = vbo;
 
 				__glcheck program.use();
 				__glcheck program.uniforms["MVP"] = matrix_;
 				__glcheck program.uniforms["color"] = color;
 				//__glcheck program.uniforms["clip"] = clip;
-				__glcheck program.uniforms.texture("tex", texture);
 
 				__glcheck program.attribs["icoord"] = vao + 0;
 
-				__glcheck glDrawArrays(GL_TRIANGLES, 0, GLsizei(coords.size() * (sizeof(graphics::char_coords_t) / sizeof(coords[0][0]))));
+				//one draw per run of chars sharing an atlas page
+				for (std::size_t first = 0; first < coords.chars.size();)
+				{
+					u32 page = coords.pages[first];
+					std::size_t last = first + 1;
+
+					while (last < coords.chars.size() && coords.pages[last] == page)
+					{
+						++last;
+					}
+
+					__glcheck program.uniforms.texture("tex", dc->glyph_texture(page));
+					__glcheck glDrawArrays(GL_TRIANGLES, GLint(first * vertices_per_char), GLsizei((last - first) * vertices_per_char));
+
+					first = last;
+				}
 			}
 		}
 	}
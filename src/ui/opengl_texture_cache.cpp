@@ -0,0 +1,405 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+#include <rfe/ui/opengl/texture_cache.h>
+#include <rfe/graphics/opengl/opengl.h>
+#include <rfe/graphics/opengl/helpers.h>
+#include <rfe/core/disk_cache.h>
+#include <rfe/graphics/block_compression.h>
+#include <stdexcept>
+
+namespace rfe
+{
+	namespace ui
+	{
+		namespace opengl
+		{
+			static GLenum pixels_format(graphics::pixels_type type)
+			{
+				switch (type)
+				{
+				case graphics::pixels_type::rgb8: return GL_RGB;
+				case graphics::pixels_type::rgba8: return GL_RGBA;
+				case graphics::pixels_type::bc1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+				case graphics::pixels_type::bc3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+				case graphics::pixels_type::bc7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+				case graphics::pixels_type::etc2_rgb8: return GL_COMPRESSED_RGB8_ETC2;
+				case graphics::pixels_type::etc2_rgba8: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+				}
+
+				throw std::runtime_error("texture_cache: unsupported pixels type");
+			}
+
+			//rows of views are hashed one by one, the padding between them is not part of the pixels
+			static u64 hash_pixels(const graphics::image &image)
+			{
+				size2i size = image.size();
+				graphics::pixels_type type = image.type();
+				graphics::image_origin origin = image.origin();
+				u64 hash = disk_cache::hash(&size, sizeof(size), disk_cache::hash(&type, sizeof(type)));
+				hash = disk_cache::hash(&origin, sizeof(origin), hash);
+
+				if (image.contiguous())
+				{
+					return disk_cache::hash(image.get(), image.bytes(), hash);
+				}
+
+				for (int y = 0; y < image.rows(0); ++y)
+				{
+					hash = disk_cache::hash(image.row(y), image.row_bytes(0), hash);
+				}
+
+				return disk_cache::hash(image.level(1), image.bytes() - image.level_offset(1), hash);
+			}
+
+			std::size_t texture_cache::upload_pixels(u32 id, const graphics::image &image)
+			{
+				__glcheck glBindTexture(GL_TEXTURE_2D, id);
+
+				GLenum format = pixels_format(image.type());
+				std::size_t pixel_bytes = graphics::block_bytes(image.type());
+
+				//gl skips padding of whole pixels only, compressed rows not at all
+				if (!image.contiguous() && (graphics::is_compressed(image.type()) || image.stride() % pixel_bytes))
+				{
+					return upload_pixels(id, image.copy());
+				}
+
+				if (graphics::is_compressed(image.type()))
+				{
+					//drivers without the format refuse it, the image is decoded and uploaded as rgba8
+					glCompressedTexImage2D(GL_TEXTURE_2D, 0, format, image.size().width(), image.size().height(), 0,
+						(GLsizei)graphics::pixels_bytes(image.type(), image.size()), image.level(0));
+
+					if (glGetError() != GL_NO_ERROR)
+					{
+						return upload_pixels(id, *graphics::decompress(image));
+					}
+
+					for (int level = 1; level < image.levels(); ++level)
+					{
+						size2i size = image.level_size(level);
+						__glcheck glCompressedTexImage2D(GL_TEXTURE_2D, level, format, size.width(), size.height(), 0,
+							(GLsizei)graphics::pixels_bytes(image.type(), size), image.level(level));
+					}
+				}
+				else
+				{
+					//rows of rgb images are not padded to 4 bytes, views are read in place with their stride
+					__glcheck graphics::opengl::pixel_unpack_settings().aligment(1).row_length(int(image.stride() / pixel_bytes)).apply();
+
+					for (int level = 0; level < image.levels(); ++level)
+					{
+						if (level == 1)
+						{
+							__glcheck graphics::opengl::pixel_unpack_settings().aligment(1).apply();
+						}
+
+						size2i size = image.level_size(level);
+						__glcheck glTexImage2D(GL_TEXTURE_2D, level, format, size.width(), size.height(), 0, format, GL_UNSIGNED_BYTE, image.level(level));
+					}
+
+					__glcheck graphics::opengl::pixel_unpack_settings().apply();
+				}
+
+				std::size_t bytes = image.bytes();
+
+				//downscaled images sample a level of about their size instead of aliasing
+				if (image.levels() == 1 && !graphics::is_compressed(image.type()))
+				{
+					__glcheck glGenerateMipmap(GL_TEXTURE_2D);
+					bytes = graphics::image(nullptr, image.size(), image.type(), graphics::image::full_chain(image.size())).bytes();
+				}
+				else
+				{
+					__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levels() - 1);
+				}
+
+				__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+				__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+				return bytes;
+			}
+
+			void texture_cache::update_pixels(u32 id, const graphics::image &image, const coord2i &area)
+			{
+				std::size_t pixel_bytes = graphics::block_bytes(image.type());
+				GLenum format = pixels_format(image.type());
+				const char *pixels = image.row(area.position.y()) + std::size_t(area.position.x()) * pixel_bytes;
+
+				__glcheck glBindTexture(GL_TEXTURE_2D, id);
+
+				//gl skips padding of whole pixels only, other strides go a row at a time
+				if (image.stride() % pixel_bytes)
+				{
+					__glcheck graphics::opengl::pixel_unpack_settings().aligment(1).apply();
+
+					for (int y = 0; y < area.size.height(); ++y)
+					{
+						__glcheck glTexSubImage2D(GL_TEXTURE_2D, 0, area.position.x(), area.position.y() + y, area.size.width(), 1,
+							format, GL_UNSIGNED_BYTE, pixels + std::size_t(y) * image.stride());
+					}
+				}
+				else
+				{
+					__glcheck graphics::opengl::pixel_unpack_settings().aligment(1).row_length(int(image.stride() / pixel_bytes)).apply();
+					__glcheck glTexSubImage2D(GL_TEXTURE_2D, 0, area.position.x(), area.position.y(), area.size.width(), area.size.height(),
+						format, GL_UNSIGNED_BYTE, pixels);
+				}
+
+				__glcheck graphics::opengl::pixel_unpack_settings().apply();
+
+				//the levels were generated by upload_pixels, they follow level 0 on the gpu
+				if (image.levels() == 1)
+				{
+					__glcheck glGenerateMipmap(GL_TEXTURE_2D);
+				}
+			}
+
+			bool texture_cache::shared(const graphics::image *image, const handle &entry) const
+			{
+				for (auto &found : m_state->by_image)
+				{
+					if (found.first != image && !found.second.image.expired() && found.second.entry.lock() == entry)
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			texture_cache::texture_cache(texture_uploader &uploader, std::size_t streamed_bytes)
+				: m_uploader(&uploader)
+				, m_streamed_bytes(streamed_bytes)
+			{
+			}
+
+			bool texture_cache::streamed(const graphics::image &image) const
+			{
+				//written while drawn, the uploader would read them without their lock
+				return m_uploader && !image.updates() && !graphics::is_compressed(image.type()) && image.levels() == 1 && image.bytes() >= m_streamed_bytes;
+			}
+
+			void texture_cache::stream_pixels(const handle &entry, const std::shared_ptr<graphics::image> &image)
+			{
+				GLenum format = pixels_format(image->type());
+
+				//sampled without mipmaps until the last rows are in, the storage is there from the start
+				__glcheck glBindTexture(GL_TEXTURE_2D, entry->id);
+				__glcheck glTexImage2D(GL_TEXTURE_2D, 0, format, image->size().width(), image->size().height(), 0, format, GL_UNSIGNED_BYTE, nullptr);
+				__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+				std::weak_ptr<const entry_t> weak_entry = entry;
+
+				m_uploader->stage(weak_entry, entry->id, image, true, [weak_entry]
+				{
+					if (auto entry_ = weak_entry.lock())
+					{
+						__glcheck glBindTexture(GL_TEXTURE_2D, entry_->id);
+						__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+					}
+				});
+			}
+
+			texture_cache::handle texture_cache::upload(const std::shared_ptr<graphics::image> &image, u64 content_hash)
+			{
+				auto entry = new entry_t;
+				entry->size = image->size();
+				entry->content_hash = content_hash;
+				entry->origin = image->origin();
+
+				__glcheck glGenTextures(1, &entry->id);
+
+				if (streamed(*image))
+				{
+					entry->bytes = graphics::image(nullptr, image->size(), image->type(), graphics::image::full_chain(image->size())).bytes();
+				}
+				else
+				{
+					entry->bytes = upload_pixels(entry->id, *image);
+				}
+
+				std::weak_ptr<state_t> weak_state = m_state;
+
+				//the last drawable holding it goes on the render thread
+				handle result(entry, [weak_state](const entry_t *entry)
+				{
+					if (auto state = weak_state.lock())
+					{
+						{
+							std::lock_guard<std::mutex> lock(state->mtx);
+							auto found = state->by_content.find(entry->content_hash);
+
+							if (found != state->by_content.end() && found->second.expired())
+							{
+								state->by_content.erase(found);
+							}
+
+							for (auto it = state->by_image.begin(); it != state->by_image.end();)
+							{
+								if (it->second.entry.expired())
+								{
+									it = state->by_image.erase(it);
+								}
+								else
+								{
+									++it;
+								}
+							}
+
+							state->resident_bytes -= entry->bytes;
+							--state->textures;
+						}
+
+						glDeleteTextures(1, &entry->id);
+					}
+
+					delete entry;
+				});
+
+				if (streamed(*image))
+				{
+					stream_pixels(result, image);
+				}
+
+				return result;
+			}
+
+			texture_cache::handle texture_cache::acquire(const graphics::texture &texture)
+			{
+				const auto &image = texture.image_ptr();
+				const auto &updates = image->updates();
+				std::unique_lock<std::mutex> updates_lock;
+
+				//pixels written while drawn are read under the lock of their writer
+				if (updates)
+				{
+					updates_lock = std::unique_lock<std::mutex>(updates->mtx);
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(m_state->mtx);
+					auto found = m_state->by_image.find(image.get());
+
+					//the address may belong to a new image once the old one went
+					if (found != m_state->by_image.end() && !found->second.image.expired() && found->second.image.lock() == image)
+					{
+						if (auto result = found->second.entry.lock())
+						{
+							if (found->second.revision == image->revision())
+							{
+								++m_state->hits;
+								return result;
+							}
+
+							//images sharing it by content keep their pixels, this one gets a texture of its own below
+							if (!shared(image.get(), result))
+							{
+								if (updates && !graphics::is_compressed(image->type()) &&
+									updates->dirty.size.width() > 0 && updates->dirty.size.height() > 0)
+								{
+									update_pixels(result->id, *image, updates->dirty);
+								}
+								else if (streamed(*image))
+								{
+									stream_pixels(result, image);
+								}
+								else
+								{
+									upload_pixels(result->id, *image);
+								}
+
+								found->second.revision = image->revision();
+
+								if (updates)
+								{
+									updates->dirty = {};
+								}
+
+								//the pixels no longer match the hash it was found by
+								auto by_content = m_state->by_content.find(result->content_hash);
+
+								if (by_content != m_state->by_content.end() && by_content->second.lock() == result)
+								{
+									m_state->by_content.erase(by_content);
+								}
+
+								++m_state->misses;
+								return result;
+							}
+						}
+					}
+				}
+
+				//same pixels in another image share the texture
+				u64 hash = hash_pixels(*image);
+
+				std::lock_guard<std::mutex> lock(m_state->mtx);
+				handle result;
+				auto found = m_state->by_content.find(hash);
+
+				if (found != m_state->by_content.end())
+				{
+					result = found->second.lock();
+				}
+
+				if (result)
+				{
+					++m_state->hits;
+				}
+				else
+				{
+					++m_state->misses;
+					result = upload(image, hash);
+					m_state->by_content[hash] = result;
+					m_state->resident_bytes += result->bytes;
+					++m_state->textures;
+				}
+
+				//the texture has every change made so far
+				if (updates)
+				{
+					updates->dirty = {};
+				}
+
+				m_state->by_image[image.get()] = { image, result, image->revision() };
+				return result;
+			}
+
+			std::size_t texture_cache::resident_bytes() const
+			{
+				std::lock_guard<std::mutex> lock(m_state->mtx);
+				return m_state->resident_bytes;
+			}
+
+			std::size_t texture_cache::textures() const
+			{
+				std::lock_guard<std::mutex> lock(m_state->mtx);
+				return m_state->textures;
+			}
+
+			u64 texture_cache::hits() const
+			{
+				std::lock_guard<std::mutex> lock(m_state->mtx);
+				return m_state->hits;
+			}
+
+			u64 texture_cache::misses() const
+			{
+				std::lock_guard<std::mutex> lock(m_state->mtx);
+				return m_state->misses;
+			}
+
+			double texture_cache::hit_rate() const
+			{
+				std::lock_guard<std::mutex> lock(m_state->mtx);
+				u64 total = m_state->hits + m_state->misses;
+				return total ? double(m_state->hits) / total : 0.0;
+			}
+		}
+	}
+}
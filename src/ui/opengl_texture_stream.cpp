@@ -0,0 +1,204 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+#include <rfe/ui/opengl/texture_stream.h>
+#include <rfe/graphics/opengl/opengl.h>
+#include <cstring>
+
+namespace rfe
+{
+	namespace ui
+	{
+		namespace opengl
+		{
+			static GLenum pixels_format(graphics::pixels_type type)
+			{
+				switch (type)
+				{
+				case graphics::pixels_type::rgb8: return GL_RGB;
+				case graphics::pixels_type::rgba8: return GL_RGBA;
+				}
+
+				throw std::runtime_error("texture_stream: unsupported pixels type");
+			}
+
+			texture_stream::texture_stream(std::shared_ptr<draw_context> dc, mode mode_, std::size_t chunks)
+				: m_dc(dc)
+				, m_mode(mode_)
+				, m_chunks(std::max<std::size_t>(chunks, 1))
+			{
+				for (std::size_t i = 0; i < m_chunks.size(); ++i)
+				{
+					m_free_chunks.push_back(i);
+				}
+			}
+
+			texture_stream::~texture_stream()
+			{
+				wait_uploads();
+
+				m_dc->thread.invoke([=]
+				{
+					remove_buffers();
+				});
+			}
+
+			std::size_t texture_stream::take_chunk()
+			{
+				std::unique_lock<std::mutex> lock(m_mtx);
+				m_cv.wait(lock, [this] { return !m_free_chunks.empty(); });
+
+				std::size_t result = m_free_chunks.back();
+				m_free_chunks.pop_back();
+				return result;
+			}
+
+			void texture_stream::release_chunk(std::size_t index)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mtx);
+					m_free_chunks.push_back(index);
+				}
+
+				m_cv.notify_all();
+			}
+
+			void texture_stream::wait_uploads()
+			{
+				std::unique_lock<std::mutex> lock(m_mtx);
+				m_cv.wait(lock, [this] { return m_free_chunks.size() == m_chunks.size(); });
+			}
+
+			void texture_stream::remove_buffers()
+			{
+				for (auto &chunk : m_chunks)
+				{
+					if (chunk.mapped)
+					{
+						__glcheck chunk.pixel_buffer.bind(gl::buffer::target::pixel_unpack);
+						__glcheck glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+						chunk.mapped = nullptr;
+					}
+
+					if (chunk.pixel_buffer.created())
+					{
+						__glcheck chunk.pixel_buffer.remove();
+					}
+
+					chunk.staging = {};
+					chunk.capacity = 0;
+				}
+
+				__glcheck glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+
+			void texture_stream::begin(size2i size, graphics::pixels_type type, std::size_t pitch)
+			{
+				m_size = size;
+				m_type = type;
+				m_pitch = pitch;
+
+				m_dc->thread.invoke([=]
+				{
+					GLuint id = 0;
+					__glcheck glGenTextures(1, &id);
+					__glcheck glBindTexture(GL_TEXTURE_2D, id);
+					__glcheck glTexImage2D(GL_TEXTURE_2D, 0, pixels_format(type), size.width(), size.height(), 0, pixels_format(type), GL_UNSIGNED_BYTE, nullptr);
+					__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+					__glcheck glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+					m_texture = id;
+				});
+			}
+
+			void texture_stream::upload(chunk_t &chunk, int first, int count, const u8 *pixels)
+			{
+				GLenum format = pixels_format(m_type);
+
+				__glcheck glBindTexture(GL_TEXTURE_2D, m_texture);
+				__glcheck gl::pixel_unpack_settings().aligment(1).apply();
+
+				//rows go in decode order, the texture is top_left
+				__glcheck glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, m_size.width(), count, format, GL_UNSIGNED_BYTE, pixels);
+				__glcheck gl::pixel_unpack_settings().apply();
+			}
+
+			void texture_stream::rows(int first, int count, const u8 *data)
+			{
+				std::size_t index = take_chunk();
+				chunk_t &chunk = m_chunks[index];
+				std::size_t bytes = m_pitch * count;
+
+				if (m_mode == mode::pixel_buffer && chunk.capacity < bytes)
+				{
+					m_dc->thread.invoke([&]
+					{
+						__glcheck chunk.pixel_buffer.set_target(gl::buffer::target::pixel_unpack);
+
+						if (chunk.mapped)
+						{
+							__glcheck chunk.pixel_buffer.bind(gl::buffer::target::pixel_unpack);
+							__glcheck glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+							chunk.mapped = nullptr;
+						}
+
+						__glcheck chunk.pixel_buffer.recreate(bytes);
+						__glcheck chunk.pixel_buffer.bind(gl::buffer::target::pixel_unpack);
+						chunk.mapped = (u8*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+						__glcheck glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+					});
+
+					chunk.capacity = bytes;
+				}
+
+				//a buffer that could not be mapped goes through the staging memory, like sub_image
+				bool mapped = m_mode == mode::pixel_buffer && chunk.mapped;
+
+				if (!mapped && chunk.staging.size() < bytes)
+				{
+					chunk.staging.resize(bytes);
+				}
+
+				u8 *target = mapped ? chunk.mapped : chunk.staging.data();
+
+				std::memcpy(target, data, bytes);
+
+				//the decoder goes on while the render thread uploads
+				m_dc->thread.invoke([=]
+				{
+					chunk_t &chunk_ = m_chunks[index];
+
+					if (mapped)
+					{
+						__glcheck chunk_.pixel_buffer.bind(gl::buffer::target::pixel_unpack);
+						__glcheck glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+						upload(chunk_, first, count, nullptr);
+
+						//orphaned, the next chunk does not wait for this upload to finish
+						__glcheck glBufferData(GL_PIXEL_UNPACK_BUFFER, chunk_.capacity, nullptr, GL_STREAM_DRAW);
+						chunk_.mapped = (u8*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+						__glcheck glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+					}
+					else
+					{
+						upload(chunk_, first, count, chunk_.staging.data());
+					}
+
+					release_chunk(index);
+				}, std::launch::async);
+			}
+
+			void texture_stream::end()
+			{
+				wait_uploads();
+
+				m_dc->thread.invoke([=]
+				{
+					remove_buffers();
+				});
+			}
+		}
+	}
+}
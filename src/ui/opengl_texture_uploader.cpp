@@ -0,0 +1,425 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+#include <rfe/ui/opengl/texture_uploader.h>
+#include <rfe/graphics/opengl/opengl.h>
+#include <rfe/graphics/opengl/helpers.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace rfe
+{
+	namespace ui
+	{
+		namespace opengl
+		{
+			static const std::size_t npos = std::size_t(-1);
+
+			static GLenum pixels_format(graphics::pixels_type type)
+			{
+				switch (type)
+				{
+				case graphics::pixels_type::rgb8: return GL_RGB;
+				case graphics::pixels_type::rgba8: return GL_RGBA;
+				default: break;
+				}
+
+				throw std::runtime_error("texture_uploader: unsupported pixels type");
+			}
+
+			static std::size_t pitch(const graphics::image &image)
+			{
+				return std::size_t(image.size().width()) * graphics::block_bytes(image.type());
+			}
+
+			//offsets stay 16 byte aligned for the copies
+			static std::size_t ring_bytes(std::size_t bytes)
+			{
+				return (bytes + 15) & ~std::size_t(15);
+			}
+
+			texture_uploader::texture_uploader()
+				: texture_uploader(settings{})
+			{
+			}
+
+			texture_uploader::texture_uploader(const settings &settings_)
+				: m_settings(settings_)
+			{
+			}
+
+			texture_uploader::~texture_uploader()
+			{
+				//gl objects are gone with the context, only the workers are waited for
+				m_workers.wait();
+			}
+
+			bool texture_uploader::allocate(std::size_t size, std::size_t &offset)
+			{
+				size = ring_bytes(size);
+
+				if (!m_mapped || size > m_settings.staging_bytes)
+				{
+					return false;
+				}
+
+				if (m_allocations.empty())
+				{
+					offset = 0;
+				}
+				else
+				{
+					std::size_t tail = m_allocations.front().offset;
+
+					//not wrapped, the free space is past the head and before the tail
+					if (m_head > tail && m_head + size <= m_settings.staging_bytes)
+					{
+						offset = m_head;
+					}
+					else if (m_head > tail && size <= tail)
+					{
+						offset = 0;
+					}
+					else if (m_head <= tail && m_head + size <= tail)
+					{
+						offset = m_head;
+					}
+					else
+					{
+						return false;
+					}
+				}
+
+				m_head = offset + size;
+				m_allocations.push_back({ offset, size, false });
+				return true;
+			}
+
+			void texture_uploader::release(std::size_t offset)
+			{
+				for (auto &allocation : m_allocations)
+				{
+					if (allocation.offset == offset && !allocation.released)
+					{
+						allocation.released = true;
+						break;
+					}
+				}
+
+				while (!m_allocations.empty() && m_allocations.front().released)
+				{
+					m_allocations.pop_front();
+				}
+
+				if (m_allocations.empty())
+				{
+					m_head = 0;
+				}
+			}
+
+			void texture_uploader::copy(std::shared_ptr<job_t> job)
+			{
+				m_workers.invoke([=]
+				{
+					const graphics::image &image = *job->image;
+
+					//the ring holds tight rows, views are packed while copying
+					if (image.contiguous())
+					{
+						std::memcpy(m_mapped + job->offset, image.get(), job->pitch * job->size.height());
+					}
+					else
+					{
+						for (int y = 0; y < job->size.height(); ++y)
+						{
+							std::memcpy(m_mapped + job->offset + job->pitch * y, image.row(y), job->pitch);
+						}
+					}
+
+					std::lock_guard<std::mutex> lock(m_mtx);
+					job->staged = true;
+					job->image.reset();
+				}, std::launch::async);
+			}
+
+			void texture_uploader::init()
+			{
+				m_initialized = true;
+
+				//without persistent mappings every job is uploaded from its image
+				if (!glBufferStorage || !glFenceSync)
+				{
+					return;
+				}
+
+				GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+				__glcheck glGenBuffers(1, &m_buffer);
+				__glcheck glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+				__glcheck glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_settings.staging_bytes, nullptr, flags);
+				m_mapped = (u8*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_settings.staging_bytes, flags);
+				__glcheck glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+
+			void texture_uploader::retire()
+			{
+				std::vector<std::function<void()>> done;
+
+				{
+					std::lock_guard<std::mutex> lock(m_mtx);
+
+					//fences signal in the order they were put
+					while (!m_batches.empty())
+					{
+						batch_t &batch = m_batches.front();
+						GLenum status = glClientWaitSync((GLsync)batch.fence, 0, 0);
+
+						if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+						{
+							break;
+						}
+
+						if (batch.bytes)
+						{
+							auto now = clock::now();
+							m_busy_seconds += std::chrono::duration<double>(now - std::max(batch.issued, m_last_retire)).count();
+							m_last_retire = now;
+							m_uploaded_bytes += batch.bytes;
+						}
+
+						glDeleteSync((GLsync)batch.fence);
+
+						for (std::size_t offset : batch.allocations)
+						{
+							release(offset);
+						}
+
+						for (auto &callback : batch.done)
+						{
+							done.push_back(std::move(callback));
+						}
+
+						m_batches.pop_front();
+					}
+				}
+
+				for (auto &callback : done)
+				{
+					callback();
+				}
+			}
+
+			void texture_uploader::stage(std::weak_ptr<const void> owner, u32 texture, std::shared_ptr<const graphics::image> image,
+				bool mipmaps, std::function<void()> done)
+			{
+				pixels_format(image->type());
+
+				//gl skips padding of whole pixels only
+				if (image->stride() % graphics::block_bytes(image->type()))
+				{
+					image = std::make_shared<const graphics::image>(image->copy());
+				}
+
+				auto job = std::make_shared<job_t>();
+				job->owner = std::move(owner);
+				job->texture = texture;
+				job->size = image->size();
+				job->type = image->type();
+				job->pitch = pitch(*image);
+				job->image = std::move(image);
+				job->mipmaps = mipmaps;
+				job->done = std::move(done);
+				job->offset = npos;
+
+				std::lock_guard<std::mutex> lock(m_mtx);
+
+				if (allocate(job->pitch * job->size.height(), job->offset))
+				{
+					copy(job);
+				}
+
+				m_jobs.push_back(job);
+			}
+
+			void texture_uploader::process()
+			{
+				if (!m_initialized)
+				{
+					init();
+				}
+
+				if (m_mapped)
+				{
+					retire();
+				}
+
+				batch_t batch{ nullptr, {}, {}, 0, clock::now() };
+				std::size_t budget = m_settings.frame_budget;
+				//textures of jobs still being copied, later jobs must not fill them first
+				std::vector<u32> waiting;
+
+				{
+					std::lock_guard<std::mutex> lock(m_mtx);
+
+					for (auto it = m_jobs.begin(); it != m_jobs.end() && budget > 0;)
+					{
+						auto job = *it;
+						bool copying = job->offset != npos && !job->staged;
+
+						if (copying || std::find(waiting.begin(), waiting.end(), job->texture) != waiting.end())
+						{
+							waiting.push_back(job->texture);
+							++it;
+							continue;
+						}
+
+						if (job->owner.expired())
+						{
+							//slices issued earlier may still be read from the ring, it is freed with this batch's fence
+							if (job->offset != npos)
+							{
+								batch.allocations.push_back(job->offset);
+							}
+
+							it = m_jobs.erase(it);
+							continue;
+						}
+
+						//staged before the ring had room
+						if (job->offset == npos && m_mapped && ring_bytes(job->pitch * job->size.height()) <= m_settings.staging_bytes)
+						{
+							if (allocate(job->pitch * job->size.height(), job->offset))
+							{
+								copy(job);
+							}
+
+							waiting.push_back(job->texture);
+							++it;
+							continue;
+						}
+
+						int rows = (int)std::min<std::size_t>(job->size.height() - job->next_row, std::max<std::size_t>(budget / job->pitch, 1));
+						std::size_t bytes = job->pitch * rows;
+						std::size_t first = job->pitch * job->next_row;
+						GLenum format = pixels_format(job->type);
+
+						__glcheck glBindTexture(GL_TEXTURE_2D, job->texture);
+
+						if (job->offset != npos)
+						{
+							__glcheck graphics::opengl::pixel_unpack_settings().aligment(1).apply();
+							__glcheck glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+							__glcheck glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job->next_row, job->size.width(), rows, format, GL_UNSIGNED_BYTE, (const void*)(job->offset + first));
+							__glcheck glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+						}
+						else
+						{
+							//larger than the ring, or no ring at all. read in place with the stride of the image
+							const graphics::image &image = *job->image;
+							__glcheck graphics::opengl::pixel_unpack_settings().aligment(1).row_length(int(image.stride() / graphics::block_bytes(job->type))).apply();
+							__glcheck glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job->next_row, job->size.width(), rows, format, GL_UNSIGNED_BYTE, image.row(job->next_row));
+						}
+
+						__glcheck graphics::opengl::pixel_unpack_settings().apply();
+
+						job->next_row += rows;
+						budget = bytes < budget ? budget - bytes : 0;
+						batch.bytes += bytes;
+
+						if (job->next_row < job->size.height())
+						{
+							break;
+						}
+
+						if (job->mipmaps)
+						{
+							__glcheck glGenerateMipmap(GL_TEXTURE_2D);
+						}
+
+						if (job->offset != npos)
+						{
+							batch.allocations.push_back(job->offset);
+						}
+
+						if (job->done)
+						{
+							batch.done.push_back(std::move(job->done));
+						}
+
+						it = m_jobs.erase(it);
+					}
+
+					//a batch of dropped jobs only still has a fence to put, for the ring memory they used
+					if ((batch.bytes || !batch.allocations.empty()) && m_mapped)
+					{
+						batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+						m_batches.push_back(std::move(batch));
+						return;
+					}
+
+					//without fences the copies were done by the driver before returning
+					if (batch.bytes)
+					{
+						auto now = clock::now();
+						m_busy_seconds += std::chrono::duration<double>(now - batch.issued).count();
+						m_uploaded_bytes += batch.bytes;
+					}
+				}
+
+				for (auto &callback : batch.done)
+				{
+					callback();
+				}
+			}
+
+			void texture_uploader::clear()
+			{
+				m_workers.wait();
+
+				std::lock_guard<std::mutex> lock(m_mtx);
+
+				for (auto &batch : m_batches)
+				{
+					glDeleteSync((GLsync)batch.fence);
+				}
+
+				if (m_buffer)
+				{
+					__glcheck glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+					__glcheck glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+					__glcheck glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+					__glcheck glDeleteBuffers(1, &m_buffer);
+				}
+
+				m_batches.clear();
+				m_jobs.clear();
+				m_allocations.clear();
+				m_head = 0;
+				m_buffer = 0;
+				m_mapped = nullptr;
+				m_initialized = false;
+			}
+
+			std::size_t texture_uploader::pending() const
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				return m_jobs.size();
+			}
+
+			u64 texture_uploader::uploaded_bytes() const
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				return m_uploaded_bytes;
+			}
+
+			double texture_uploader::throughput() const
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				return m_busy_seconds > 0.0 ? m_uploaded_bytes / m_busy_seconds : 0.0;
+			}
+		}
+	}
+}
@@ -67,7 +67,7 @@ namespace rfe
 		{
 			if (auto drawable_ = drawable.lock())
 			{
-				drawable_->draw(clip, matrix);
+				drawable_->draw(clip(), matrix());
 			}
 		}
 	}
@@ -1,25 +1,138 @@
 #include <rfe/ui/scrollable.h>
 #include <rfe/ui/widget.h>
+#include <algorithm>
+#include <cmath>
 
 namespace rfe
 {
 	namespace ui
 	{
-		scrollable::scrollable(widget *parent)
+		scrollable::scrollable(widget *parent) : m_parent(parent)
 		{
-			horizontal_scroll.onchanged += [=](int old_value, int new_value)
+			horizontal_scroll.onchanged += [=](ignore, int new_value)
 			{
-				parent->sizer_flags().x(parent->x() + (new_value - old_value));
-				parent->refresh();
+				m_parent->scroll_offset({ new_value, vertical_scroll() });
 				return event_result::handled;
 			};
 
-			vertical_scroll.onchanged += [=](int old_value, int new_value)
+			vertical_scroll.onchanged += [=](ignore, int new_value)
 			{
-				parent->sizer_flags().y(parent->y() + (new_value - old_value));
-				parent->refresh();
+				m_parent->scroll_offset({ horizontal_scroll(), new_value });
 				return event_result::handled;
 			};
 		}
+
+		size2i scrollable::content_size() const
+		{
+			return m_parent->measured_size();
+		}
+
+		void scrollable::drag(point2i start_point, point2i current_point)
+		{
+			auto now = clock::now();
+
+			if (!m_dragging)
+			{
+				stop_scrolling();
+
+				m_dragging = true;
+				m_drag_point = start_point;
+				m_drag_time = now;
+				m_velocity = {};
+			}
+
+			point2i delta = current_point - m_drag_point;
+			double elapsed = std::chrono::duration<double>(now - m_drag_time).count();
+
+			if (elapsed > 0.0)
+			{
+				//smoothed, so a single jittery motion event does not decide the fling
+				point2f instant = (point2f)delta / (float)elapsed;
+				m_velocity = m_velocity * 0.2f + instant * 0.8f;
+			}
+
+			m_drag_point = current_point;
+			m_drag_time = now;
+
+			if (horizontal_drag && delta.x() != 0)
+			{
+				horizontal_scroll = horizontal_scroll() + delta.x();
+			}
+
+			if (vertical_drag && delta.y() != 0)
+			{
+				vertical_scroll = vertical_scroll() + delta.y();
+			}
+		}
+
+		void scrollable::fling()
+		{
+			if (!m_dragging)
+			{
+				return;
+			}
+
+			m_dragging = false;
+
+			//the pointer rested before release
+			if (clock::now() - m_drag_time > std::chrono::milliseconds(100))
+			{
+				return;
+			}
+
+			point2f velocity{ horizontal_drag ? m_velocity.x() : 0.f, vertical_drag ? m_velocity.y() : 0.f };
+
+			if (std::abs(velocity.x()) < 50.f && std::abs(velocity.y()) < 50.f)
+			{
+				return;
+			}
+
+			point2i start{ horizontal_scroll(), vertical_scroll() };
+			std::size_t id = ++m_fling_id;
+			double time_constant = std::chrono::duration<double>(kinetic_time_constant).count();
+
+			animation::element element{ [=](double x)
+			{
+				if (m_fling_id != id)
+				{
+					return false;
+				}
+
+				double time = x * time_constant * 6.0;
+				double distance = time_constant * (1.0 - std::exp(-time / time_constant));
+
+				//scrolls stay in [-(content - viewport), 0], the fling ends once every moving axis is at an edge
+				size2i content = content_size();
+				size2i viewport = m_parent->size();
+				point2i target{ start.x() + int(velocity.x() * distance), start.y() + int(velocity.y() * distance) };
+				bool moving = false;
+
+				for (int axe = 0; axe < 2; ++axe)
+				{
+					int lowest = -std::max(content[axe] - viewport[axe], 0);
+					int value = std::min(std::max(target[axe], lowest), 0);
+
+					if (velocity[axe] != 0.f && value == target[axe])
+					{
+						moving = true;
+					}
+
+					target[axe] = value;
+				}
+
+				horizontal_scroll = target.x();
+				vertical_scroll = target.y();
+				return moving;
+			}, kinetic_time_constant * 6 };
+
+			element.easing(animation::easing::linear);
+
+			m_parent->play(animation::page{ element });
+		}
+
+		void scrollable::stop_scrolling()
+		{
+			++m_fling_id;
+		}
 	}
 }
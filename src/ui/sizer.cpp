@@ -31,7 +31,7 @@ namespace rfe
 			height_binder.unbind_all();
 			m_size[0].type = sizer_elem_type::absolute;
 			m_size[0].value = value;
-			invalidate_widget(true);
+			invalidate_widget();
 			return *this;
 		}
 
@@ -48,7 +48,7 @@ namespace rfe
 			height_binder.unbind_all();
 			m_size[1].type = sizer_elem_type::absolute;
 			m_size[1].value = value;
-			invalidate_widget(true);
+			invalidate_widget();
 			return *this;
 		}
 
@@ -65,7 +65,7 @@ namespace rfe
 			x_binder.unbind_all();
 			m_pos[0].type = sizer_elem_type::absolute;
 			m_pos[0].value = value;
-			invalidate_widget(true);
+			invalidate_widget();
 			return *this;
 		}
 
@@ -82,7 +82,7 @@ namespace rfe
 			y_binder.unbind_all();
 			m_pos[1].type = sizer_elem_type::absolute;
 			m_pos[1].value = value;
-			invalidate_widget(true);
+			invalidate_widget();
 			return *this;
 		}
 
@@ -226,11 +226,11 @@ namespace rfe
 			return *this;
 		}
 
-		void sizer_flags::invalidate_widget(bool is_const)
+		void sizer_flags::invalidate_widget()
 		{
 			if (auto parent_ = m_parent->parent())
 			{
-				parent_->refresh(is_const);
+				parent_->refresh();
 			}
 		}
 	}
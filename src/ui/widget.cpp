@@ -1,6 +1,8 @@
 #include <rfe/ui/widget.h>
 #include <rfe/core/thread_queue.h>
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 namespace rfe
 {
@@ -13,6 +15,36 @@ namespace rfe
 			return instance;
 		}
 
+		struct layout_pool_t
+		{
+			thread_queue queue = make_direct_thread_queue();
+			std::size_t threads = 1;
+		};
+
+		static layout_pool_t& layout_pool()
+		{
+			static layout_pool_t instance;
+
+			return instance;
+		}
+
+		//set on threads laying out a subtree, nested subtrees stay on the same thread. sizes and positions
+		//are placed aside and the widgets listed here, the thread that started the pass applies them
+		static thread_local std::vector<widget*> *g_layout_changes = nullptr;
+
+		void layout_threads(std::size_t count)
+		{
+			count = std::max<std::size_t>(count, 1);
+
+			layout_pool().queue = count > 1 ? make_thread_pool_queue(count - 1) : make_direct_thread_queue();
+			layout_pool().threads = count;
+		}
+
+		std::size_t layout_threads()
+		{
+			return layout_pool().threads;
+		}
+
 		std::shared_ptr<const widget> widget::shared_ptr() const
 		{
 			return shared_from_this();
@@ -35,70 +67,30 @@ namespace rfe
 
 		matrix4f widget::calc_matrix_for(coord2f coords, size2f global_size)
 		{
-			rfe::point2f scale = coords.size / global_size;
-			rfe::point2f translate = coords.position * 2 / global_size - (rfe::point2f{ 1.f, 1.f } - scale);
-
-			return mtx::scale_offset({ scale.x(), scale.y(), 1.f }, { translate.x(), -translate.y(), 0 });
+			return widget_store_t::calc_matrix(coords, global_size);
 		}
 
-		void widget::calc_matrix()
+		void widget::invalidate_transform()
 		{
-			if (!visible_test())
-			{
-				matrix = { 0.f };
-				clip = {};
-
-				return;
-			}
-
-			auto widget_size = size();
-
-			auto parent_ = parent();
-			size2i parent_size;
-			
-			if (parent_)
-			{
-				parent_size = parent_->size();
-			}
-			else
-			{
-				parent_size = widget_size;
-			}
-
-			std::shared_ptr<const widget> top_widget;
-			point2i absolute_positon = local_to_absolute_point({}, &top_widget);
-			auto window_size = top_widget->size();
-
-			if (window_size.width() <= 0 || window_size.height() <= 0)
-			{
-				matrix = { 0.f };
-				clip = {};
-				return;
-			}
-
-			point2f clip_point_top, clip_point_bottom;
-
-			if (auto parent_ = parent())
-			{
-				clip_point_top = (point2f)(absolute_positon - position());
-				clip_point_bottom = clip_point_top + (size2f)parent_size;
-			}
-			else
-			{
-				clip_point_top = {};
-				clip_point_bottom = (size2f)widget_size;
-			}
-
-			clip_point_top = (clip_point_top * 2.f) / window_size - 1.f;
-			clip_point_bottom = (clip_point_bottom * 2.f) / window_size - 1.f;
+			m_store->invalidate(m_id);
+		}
 
-			matrix = calc_matrix_for({ (point2f)absolute_positon, (size2f)widget_size }, (size2f)window_size);
+		void widget::scroll_offset(point2i value)
+		{
+			m_store->scroll_offset(m_id, value);
+		}
 
-			clip = { clip_point_top.x(), clip_point_top.y(), clip_point_bottom.x(), clip_point_bottom.y() };
+		point2i widget::scroll_offset() const
+		{
+			return m_store->scroll_offset(m_id);
 		}
 
 		widget::widget()
 		{
+			m_store->add(m_id);
+			m_store->position(m_id, position());
+			m_store->size(m_id, size());
+
 			//bind default listeners
 
 			onclose += [this] { return doclose(); };
@@ -112,6 +104,8 @@ namespace rfe
 					return event_result::skip;
 				}
 
+				point2i scroll_offset_ = scroll_offset();
+
 				std::lock_guard<shared_read_mutex_read> lock(m_childs_mtx.read);
 
 				for (auto it = m_childs.rbegin(); it != m_childs.rend(); ++it)
@@ -120,7 +114,7 @@ namespace rfe
 
 					if (child->visible())
 					{
-						point2i child_position = child->position();
+						point2i child_position = child->position() + scroll_offset_;
 
 						if (point >= child_position && point < child_position + child->size())
 						{
@@ -196,24 +190,48 @@ namespace rfe
 				});
 			};
 
-			size.onchanged += [this](ignore, ignore)
+			size.onchanged += [this](ignore, size2i new_size)
 			{
-				refresh();
-			};
+				m_store->size(m_id, new_size);
 
-			position.onchanged += [this](ignore, ignore)
-			{
-				refresh();
+				bool arranged;
+
+				{
+					std::lock_guard<std::mutex> lock(m_arranged_size_mtx);
+					arranged = new_size == m_arranged_size;
+
+					//one change per arrange, later sets of the same size come from elsewhere
+					if (arranged)
+					{
+						m_arranged_size = { -1, -1 };
+					}
+				}
+
+				//sizes assigned by the parent arrange are already handled by the layout pass
+				if (!arranged)
+				{
+					refresh();
+
+					if (auto parent_ = parent())
+					{
+						parent_->refresh();
+					}
+				}
 			};
 
-			shown.onchanged += [this](ignore, ignore)
+			position.onchanged += [this](ignore, point2i new_position)
 			{
-				refresh();
+				m_store->position(m_id, new_position);
 			};
 
-			rotation.onchanged += [this](ignore, ignore)
+			shown.onchanged += [this](ignore, bool new_shown)
 			{
-				refresh();
+				m_store->shown(m_id, new_shown);
+
+				if (auto parent_ = parent())
+				{
+					parent_->refresh();
+				}
 			};
 
 			oninit += [this]
@@ -235,6 +253,7 @@ namespace rfe
 			parent_event_binder.unbind_all();
 			event_binder.unbind_all();
 
+			m_store->remove(m_id);
 			m_id_manager->free_id(m_id);
 			m_id = id_manager_t<decltype(m_id)>::bad_id;
 		}
@@ -253,31 +272,129 @@ namespace rfe
 			}
 		}
 
-		void widget::update_sizers()
+		bool widget::update_layout()
 		{
+			if (!m_layout_invalidated.exchange(false))
+			{
+				return false;
+			}
+
+			bool arrange_childs = m_arrange_invalidated.exchange(false);
+			bool resized = false;
+
+			std::lock_guard<shared_read_mutex_read> lock(m_childs_mtx.read);
+
+			if (!arrange_childs)
+			{
+				//only descendants were invalidated, but an automatically sized child still moves its siblings
+				arrange_childs = update_childs_layout();
+			}
+
+			if (arrange_childs)
+			{
+				resized = arrange();
+
+				if (update_childs_layout())
+				{
+					//automatical size depends on an expanded child, finish it on the next pass
+					refresh();
+				}
+			}
+
+			return resized;
 		}
 
-		void widget::update()
+		bool widget::update_childs_layout()
 		{
-			if (m_const_sizer_invalidated)
+			std::vector<widget*> independent;
+			bool resized = false;
+
+			if (layout_threads() > 1 && !g_layout_changes)
 			{
-				m_const_sizer_invalidated = false;
-				recalc_sizers(recalc_sizers_type::set_constants);
+				//once this widget is arranged, a child only touches its own subtree unless a descendant has rel_to callbacks
+				for (auto &child : m_childs)
+				{
+					if (child->m_layout_invalidated && child->relative_free_descendants())
+					{
+						independent.push_back(child.get());
+					}
+				}
+
+				if (independent.size() < 2)
+				{
+					independent.clear();
+				}
 			}
 
-			update_childs();
-			update_animation();
+			if (!independent.empty())
+			{
+				auto &pool = layout_pool();
+				std::size_t chunks = std::min(pool.threads, independent.size());
+				std::vector<char> chunk_resized(chunks);
+				std::vector<std::vector<widget*>> chunk_changes(chunks);
+
+				//fixed contiguous chunks, the calling thread takes the first one
+				auto update_chunk = [&](std::size_t chunk)
+				{
+					std::size_t begin = chunk * independent.size() / chunks;
+					std::size_t end = (chunk + 1) * independent.size() / chunks;
+
+					g_layout_changes = &chunk_changes[chunk];
+
+					for (std::size_t i = begin; i < end; ++i)
+					{
+						if (independent[i]->update_layout())
+						{
+							chunk_resized[chunk] = true;
+						}
+					}
 
-			if (m_relative_sizer_invalidated)
+					g_layout_changes = nullptr;
+				};
+
+				std::vector<std::shared_future<void>> tasks;
+				tasks.reserve(chunks - 1);
+
+				for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+				{
+					tasks.push_back(pool.queue.async_invoke([&update_chunk, chunk] { update_chunk(chunk); }));
+				}
+
+				update_chunk(0);
+
+				for (auto &task : tasks)
+				{
+					task.wait();
+				}
+
+				//change handlers and store writes run here, in chunk order
+				for (auto &changes : chunk_changes)
+				{
+					for (widget *changed : changes)
+					{
+						commit_layout(*changed);
+					}
+				}
+
+				resized = std::find(chunk_resized.begin(), chunk_resized.end(), true) != chunk_resized.end();
+			}
+
+			//everything left depends on callbacks and is laid out in order on this thread
+			for (auto &child : m_childs)
 			{
-				m_relative_sizer_invalidated = false;
-				recalc_sizers(recalc_sizers_type::set_relatives);
+				if (child->update_layout())
+				{
+					resized = true;
+				}
 			}
 
+			return resized;
+		}
+
+		void widget::update()
+		{
 			if (m_parent == nullptr)
 			{
-				//update_sizers();
-
 				thread_queue::main_thread().process_queue();
 
 				while (!events_thread().empty())
@@ -285,11 +402,21 @@ namespace rfe
 					thread_queue::main_thread().process_queue();
 					std::this_thread::sleep_for(std::chrono::milliseconds(1));
 				}
+
+				update_layout();
 			}
 
+			update_childs();
+			update_animation();
+
 			queue.process_queue();
 
-			calc_matrix();
+			if (m_parent == nullptr)
+			{
+				//absolute positions are only recomputed below widgets that moved or resized
+				m_store->update_transforms();
+			}
+
 			onrefresh();
 		}
 
@@ -334,19 +461,7 @@ namespace rfe
 			full_name = new_full_name;
 
 			set_top_widget(parent ? parent->top_widget() : nullptr);
-
-			if (parent)
-			{
-				parent_event_binder(parent->size.onchanged) += [=](ignore, ignore)
-				{
-					refresh();
-				};
-
-				parent_event_binder(parent->position.onchanged) += [=](ignore, ignore)
-				{
-					refresh();
-				};
-			}
+			m_store->parent(m_id, parent ? parent->id() : widget_store_t::no_parent);
 		}
 
 		std::shared_ptr<widget> widget::top_widget()
@@ -363,6 +478,8 @@ namespace rfe
 				m_childs.insert(m_childs.end(), child);
 			}
 
+			refresh();
+
 			return child->sizer_flags();
 		}
 
@@ -370,17 +487,21 @@ namespace rfe
 		{
 			child->set_parent(nullptr);
 
-			std::lock_guard<shared_read_mutex_write> lock(m_childs_mtx.write);
-
-			for (auto it = m_childs.begin(); it != m_childs.end();)
 			{
-				if (*it == child)
+				std::lock_guard<shared_read_mutex_write> lock(m_childs_mtx.write);
+
+				for (auto it = m_childs.begin(); it != m_childs.end();)
 				{
-					it = m_childs.erase(it);
+					if (*it == child)
+					{
+						it = m_childs.erase(it);
+					}
+					else
+						++it;
 				}
-				else
-					++it;
 			}
+
+			refresh();
 		}
 
 		event_result widget::doclose()
@@ -530,7 +651,7 @@ namespace rfe
 
 		bool widget::visible() const
 		{
-			return m_visible && alive() && shown();
+			return m_store->visible(m_id) && alive() && shown();
 		}
 
 		bool widget::hidden() const
@@ -540,44 +661,7 @@ namespace rfe
 
 		bool widget::visible_test()
 		{
-			auto test = [this]
-			{
-				if (!shown())
-				{
-					return false;
-				}
-
-				if (auto parent_ = parent())
-				{
-					point2i top_pos = position();
-					point2i down_pos = top_pos + size();
-
-					if (down_pos.x() <= 0 || down_pos.y() <= 0)
-					{
-						return false;
-					}
-
-					size2i parent_size = parent_->size();
-
-					if (parent_size.width() == 0 || parent_size.height() == 0)
-					{
-						return false;
-					}
-
-					if (top_pos.x() >= parent_size.width() || top_pos.y() >= parent_size.height())
-					{
-						return false;
-					}
-				}
-
-				return true;
-			};
-
-			bool test_result = test();
-
-			m_visible = test_result;
-
-			return test_result;
+			return m_store->visible(m_id);
 		}
 
 		coord2i widget::coord()
@@ -587,69 +671,32 @@ namespace rfe
 
 		point2i widget::absolute_to_local_point(point2i point, std::shared_ptr<const widget>* top_widget) const
 		{
-			point2i local_positon = point;
-
 			if (top_widget)
 			{
-				*top_widget = shared_ptr();
+				*top_widget = m_top_widget ? m_top_widget : shared_ptr();
 			}
 
-			if (auto parent_ = parent())
-			{
-				local_positon -= position();
-				while (parent_->parent())
-				{
-					local_positon -= parent_->position();
-					parent_ = parent_->parent();
-				}
-
-				if (top_widget)
-				{
-					*top_widget = parent_;
-				}
-			}
-
-			return local_positon;
+			return point - m_store->absolute_position(m_id);
 		}
 
 		point2i widget::local_to_absolute_point(point2i point, std::shared_ptr<const widget>* top_widget) const
 		{
-			point2i absolute_positon = point;
-
 			if (top_widget)
 			{
-				*top_widget = shared_ptr();
-			}
-
-			if (auto parent_ = parent())
-			{
-				absolute_positon += position();
-				while (parent_->parent())
-				{
-					absolute_positon += parent_->position();
-					parent_ = parent_->parent();
-				}
-
-				if (top_widget)
-				{
-					*top_widget = parent_;
-				}
+				*top_widget = m_top_widget ? m_top_widget : shared_ptr();
 			}
 
-			return absolute_positon;
+			return point + m_store->absolute_position(m_id);
 		}
 
-		void widget::refresh(bool is_const)
+		void widget::refresh()
 		{
-			if (is_const)
-			{
-				m_const_sizer_invalidated = true;
-			}
-			else
+			m_arrange_invalidated = true;
+
+			//mark the path to the root, an invalidated ancestor is already on it
+			for (widget *node = this; node && !node->m_layout_invalidated.exchange(true); node = node->m_parent.get())
 			{
-				m_relative_sizer_invalidated = true;
 			}
-			//recalc_sizers(recalc_sizers_type::set_relatives);
 		}
 
 		void widget::draw(bool clear_and_flip)
@@ -708,146 +755,270 @@ namespace rfe
 			});
 		}
 
-		void widget::recalc_sizers(recalc_sizers_type recalc_type)
+		bool widget::relative_free_descendants()
 		{
+			std::lock_guard<shared_read_mutex_read> lock(m_childs_mtx.read);
+			for (auto &child : m_childs)
+			{
+				const class sizer_flags &flags = child->m_sizer_flags;
+
+				for (byte axe = 0; axe < 2; ++axe)
+				{
+					if (flags.m_pos[axe].type == sizer_elem_type::relative || flags.m_size[axe].type == sizer_elem_type::relative)
+					{
+						return false;
+					}
+				}
+
+				if (!child->relative_free_descendants())
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		size2i widget::layout_size() const
+		{
+			return m_layout_size_pending ? m_layout_size : size();
+		}
+
+		point2i widget::layout_position() const
+		{
+			return m_layout_position_pending ? m_layout_position : position();
+		}
+
+		void widget::arrange_child_size(widget &child, size2i value)
+		{
+			if (child.layout_size() == value)
+			{
+				return;
+			}
+
+			child.m_arrange_invalidated = true;
+			child.m_layout_invalidated = true;
+
+			if (g_layout_changes)
+			{
+				if (!child.m_layout_size_pending && !child.m_layout_position_pending)
+				{
+					g_layout_changes->push_back(&child);
+				}
+
+				child.m_layout_size = value;
+				child.m_layout_size_pending = true;
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(child.m_arranged_size_mtx);
+				child.m_arranged_size = value;
+			}
+
+			child.size = value;
+			child.m_store->size(child.m_id, value);
+		}
+
+		void widget::arrange_child_position(widget &child, point2i value)
+		{
+			if (child.layout_position() == value)
+			{
+				return;
+			}
+
+			if (g_layout_changes)
+			{
+				if (!child.m_layout_size_pending && !child.m_layout_position_pending)
+				{
+					g_layout_changes->push_back(&child);
+				}
+
+				child.m_layout_position = value;
+				child.m_layout_position_pending = true;
+				return;
+			}
+
+			child.move(value);
+			child.m_store->position(child.m_id, value);
+		}
+
+		void widget::commit_layout(widget &target)
+		{
+			if (target.m_layout_size_pending)
+			{
+				target.m_layout_size_pending = false;
+
+				if (target.size() != target.m_layout_size)
+				{
+					{
+						std::lock_guard<std::mutex> lock(target.m_arranged_size_mtx);
+						target.m_arranged_size = target.m_layout_size;
+					}
+
+					target.size = target.m_layout_size;
+					target.m_store->size(target.m_id, target.m_layout_size);
+				}
+			}
+
+			if (target.m_layout_position_pending)
+			{
+				target.m_layout_position_pending = false;
+
+				if (target.position() != target.m_layout_position)
+				{
+					target.move(target.m_layout_position);
+					target.m_store->position(target.m_id, target.m_layout_position);
+				}
+			}
+		}
+
+		bool widget::arrange()
+		{
+			size2i widget_size = layout_size();
 			size2i internal_size{};
 			int widget_axe = (int)orientation();
-			int position[2] = { 0, get_size(widget_axe) };
+			int position[2] = { 0, widget_size[widget_axe] };
 
 			std::lock_guard<shared_read_mutex_read> lock(m_childs_mtx.read);
 			for (auto &child : m_childs)
 			{
+				const class sizer_flags &flags = child->m_sizer_flags;
+
+				//automatically sized childs are measured before they are placed
+				if (flags.m_size[0].type == sizer_elem_type::automatical || flags.m_size[1].type == sizer_elem_type::automatical)
+				{
+					child->update_layout();
+				}
+
+				point2i child_position = child->layout_position();
+				size2i child_size = child->layout_size();
+
 				for (byte axe = 0; axe < 2; ++axe)
 				{
-					switch (sizer_elem_type type = child->m_sizer_flags.m_pos[axe].type)
+					switch (sizer_elem_type type = flags.m_pos[axe].type)
 					{
-					case sizer_elem_type::ignore:
-						break;
-
 					case sizer_elem_type::counter:
 					case sizer_elem_type::expand:
-						if (!child->m_sizer_flags.m_pull_back)
+						if (!flags.m_pull_back)
 						{
 							if (axe == widget_axe)
 							{
-								child->set_position(axe, position[0] + child->get_front_border(axe));
+								child_position[axe] = position[0] + child->get_front_border(axe);
 							}
 							else
 							{
-								child->set_position(axe, child->get_front_border(axe));
+								child_position[axe] = child->get_front_border(axe);
 							}
 						}
 						else if (type == sizer_elem_type::expand)
 						{
-							child->set_position(axe, child->get_front_border(axe));
+							child_position[axe] = child->get_front_border(axe);
 						}
 						break;
 
 					case sizer_elem_type::absolute:
-						if (recalc_type == recalc_sizers_type::set_constants)
-						{
-							child->set_position(axe, child->m_sizer_flags.m_pos[axe].value);
-						}
+						child_position[axe] = flags.m_pos[axe].value;
 						break;
 
-					case sizer_elem_type::relative:
-						child->set_position(axe, child->m_sizer_flags.m_pos[axe].rel_to());
+					default:
 						break;
 					}
 
-					switch (child->m_sizer_flags.m_size[axe].type)
+					switch (flags.m_size[axe].type)
 					{
-					case sizer_elem_type::automatical:
-					case sizer_elem_type::ignore:
-					case sizer_elem_type::counter:
-						break;
-
 					case sizer_elem_type::expand:
-						if (recalc_type == recalc_sizers_type::set_relatives)
+						if (!flags.m_pull_back)
 						{
-							if (!child->m_sizer_flags.m_pull_back)
-							{
-								child->set_size(axe, get_size(axe) - child->get_position(axe) - child->get_back_border(axe));
-							}
-							else
-							{
-								child->set_size(axe, (widget_axe == axe ? position[1] : get_size(axe)) - child->get_back_border(axe) - child->get_position(axe));
-							}
+							child_size[axe] = widget_size[axe] - child_position[axe] - child->get_back_border(axe);
+						}
+						else
+						{
+							child_size[axe] = (widget_axe == axe ? position[1] : widget_size[axe]) - child->get_back_border(axe) - child_position[axe];
 						}
 						break;
 
 					case sizer_elem_type::absolute:
-						if (recalc_type == recalc_sizers_type::set_constants)
-						{
-							child->set_size(axe, child->m_sizer_flags.m_size[axe].value);
-						}
+						child_size[axe] = flags.m_size[axe].value;
 						break;
 
 					case sizer_elem_type::relative:
-						if (recalc_type == recalc_sizers_type::set_relatives)
-						{
-							child->set_size(axe, child->m_sizer_flags.m_size[axe].rel_to());
-						}
+						child_size[axe] = flags.m_size[axe].rel_to();
+						break;
+
+					default:
 						break;
 					}
+				}
+
+				arrange_child_size(*child, child_size);
+
+				for (byte axe = 0; axe < 2; ++axe)
+				{
+					sizer_elem_type type = flags.m_pos[axe].type;
 
-					if (recalc_type == recalc_sizers_type::set_relatives)
+					//relative positions are evaluated after the size, so centering sees the new one
+					if (type == sizer_elem_type::relative)
 					{
-						if (child->m_sizer_flags.m_pull_back &&
-							(child->m_sizer_flags.m_pos[axe].type == sizer_elem_type::counter || child->m_sizer_flags.m_pos[axe].type == sizer_elem_type::expand))
-						{
-							child->set_position(axe, (widget_axe == axe ? position[1] : get_size(axe)) - child->get_front_border(axe) - child->get_size(axe));
-						}
+						child_position[axe] = flags.m_pos[axe].rel_to();
+					}
+					else if (flags.m_pull_back && (type == sizer_elem_type::counter || type == sizer_elem_type::expand))
+					{
+						child_position[axe] = (widget_axe == axe ? position[1] : widget_size[axe]) - child->get_front_border(axe) - child_size[axe];
 					}
 
-					switch (child->m_sizer_flags.m_fit)
+					switch (flags.m_fit)
 					{
 					case fit_type::never:
 						break;
 
 					case fit_type::if_shown:
 					case fit_type::always:
-						if (child->m_sizer_flags.m_fit == fit_type::always || child->shown())
+						if (flags.m_fit == fit_type::always || child->shown())
 						{
-							int down = child->get_position(axe) + child->get_size(axe) + child->get_back_border(axe);
+							int down = child_position[axe] + child_size[axe] + child->get_back_border(axe);
 
 							if (axe == widget_axe)
 							{
-								if (!child->m_sizer_flags.m_pull_back)
+								if (!flags.m_pull_back)
 								{
 									position[0] = std::max<int>(position[0], down);
 								}
 								else
 								{
-									position[1] = std::min<int>(position[1], child->get_position(axe));
+									position[1] = std::min<int>(position[1], child_position[axe]);
 								}
 							}
 
-							switch (axe)
-							{
-							case 0: internal_size.width(std::max<int>(internal_size.width(), down)); break;
-							case 1: internal_size.height(std::max<int>(internal_size.height(), down)); break;
-							}
+							internal_size[axe] = std::max<int>(internal_size[axe], down);
 						}
 						break;
 					}
 				}
+
+				arrange_child_position(*child, child_position);
 			}
 
-			if (recalc_type == recalc_sizers_type::set_relatives)
+			m_measured_size = internal_size;
+
+			bool auto_width = m_sizer_flags.m_size[0].type == sizer_elem_type::automatical;
+			bool auto_height = m_sizer_flags.m_size[1].type == sizer_elem_type::automatical;
+
+			if (!auto_width && !auto_height)
 			{
-				bool auto_width = m_sizer_flags.m_size[0].type == sizer_elem_type::automatical;
-				bool auto_height = m_sizer_flags.m_size[1].type == sizer_elem_type::automatical;
+				return false;
+			}
 
-				if (auto_width || auto_height)
-				{
-					auto widget_size = size();
-					int width_ = auto_width ? internal_size.width() : widget_size.width();
-					int height_ = auto_height ? internal_size.height() : widget_size.height();
+			size2i new_size{ auto_width ? internal_size.width() : widget_size.width(), auto_height ? internal_size.height() : widget_size.height() };
 
-					size = { width_, height_ };
-				}
+			if (new_size == widget_size)
+			{
+				return false;
 			}
+
+			//own childs are placed again with the new size, the parent is told through the result
+			arrange_child_size(*this, new_size);
+			return true;
 		}
 	}
 }
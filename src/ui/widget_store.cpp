@@ -0,0 +1,309 @@
+#include <rfe/ui/widget_store.h>
+
+namespace rfe
+{
+	namespace ui
+	{
+		std::shared_ptr<widget_store_t> widget_store()
+		{
+			static auto instance = std::make_shared<widget_store_t>();
+
+			return instance;
+		}
+
+		matrix4f widget_store_t::calc_matrix(coord2f coords, size2f global_size)
+		{
+			rfe::point2f scale = coords.size / global_size;
+			rfe::point2f translate = coords.position * 2 / global_size - (rfe::point2f{ 1.f, 1.f } - scale);
+
+			return mtx::scale_offset({ scale.x(), scale.y(), 1.f }, { translate.x(), -translate.y(), 0 });
+		}
+
+		void widget_store_t::reserve(u32 id)
+		{
+			if (id < m_flags.size())
+			{
+				return;
+			}
+
+			std::size_t count = std::max<std::size_t>(id + 1, m_flags.size() * 2);
+
+			m_positions.resize(count);
+			m_sizes.resize(count);
+			m_flags.resize(count);
+			m_parents.resize(count, no_parent);
+			m_scroll_offsets.resize(count);
+			m_absolute_positions.resize(count);
+			m_top_sizes.resize(count);
+			m_matrices.resize(count, matrix4f{ 0.f });
+			m_clips.resize(count);
+		}
+
+		u32 widget_store_t::depth(u32 id)
+		{
+			if (m_depths[id] != no_parent)
+			{
+				return m_depths[id];
+			}
+
+			u32 parent = m_parents[id];
+			u32 result = parent == no_parent || !(m_flags[parent] & is_used) ? 0 : depth(parent) + 1;
+
+			m_depths[id] = result;
+			return result;
+		}
+
+		void widget_store_t::rebuild_order()
+		{
+			m_depths.assign(m_flags.size(), no_parent);
+
+			u32 max_depth = 0;
+
+			for (u32 id = 0; id < m_flags.size(); ++id)
+			{
+				if (m_flags[id] & is_used)
+				{
+					max_depth = std::max(max_depth, depth(id));
+				}
+			}
+
+			//counting sort by depth
+			std::vector<u32> offsets(max_depth + 2);
+
+			for (u32 id = 0; id < m_flags.size(); ++id)
+			{
+				if (m_flags[id] & is_used)
+				{
+					++offsets[m_depths[id] + 1];
+				}
+			}
+
+			for (u32 i = 1; i < offsets.size(); ++i)
+			{
+				offsets[i] += offsets[i - 1];
+			}
+
+			m_order.resize(offsets.back());
+
+			for (u32 id = 0; id < m_flags.size(); ++id)
+			{
+				if (m_flags[id] & is_used)
+				{
+					m_order[offsets[m_depths[id]]++] = id;
+				}
+			}
+
+			m_order_invalidated = false;
+		}
+
+		void widget_store_t::add(u32 id)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			reserve(id);
+
+			m_positions[id] = {};
+			m_sizes[id] = {};
+			m_flags[id] = is_used | transform_invalidated;
+			m_parents[id] = no_parent;
+			m_scroll_offsets[id] = {};
+			m_absolute_positions[id] = {};
+			m_top_sizes[id] = {};
+			m_matrices[id] = { 0.f };
+			m_clips[id] = {};
+			m_order_invalidated = true;
+		}
+
+		void widget_store_t::remove(u32 id)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+
+			if (id < m_flags.size())
+			{
+				m_flags[id] = 0;
+				m_parents[id] = no_parent;
+				m_order_invalidated = true;
+			}
+		}
+
+		void widget_store_t::parent(u32 id, u32 parent)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_parents[id] = parent;
+			m_flags[id] |= transform_invalidated;
+			m_order_invalidated = true;
+		}
+
+		void widget_store_t::position(u32 id, point2i value)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_positions[id] = value;
+			m_flags[id] |= transform_invalidated;
+		}
+
+		void widget_store_t::size(u32 id, size2i value)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_sizes[id] = value;
+			m_flags[id] |= transform_invalidated;
+		}
+
+		void widget_store_t::shown(u32 id, bool value)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+
+			if (value)
+			{
+				m_flags[id] |= is_shown;
+			}
+			else
+			{
+				m_flags[id] &= ~is_shown;
+			}
+
+			m_flags[id] |= transform_invalidated;
+		}
+
+		void widget_store_t::scroll_offset(u32 id, point2i value)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_scroll_offsets[id] = value;
+			m_flags[id] |= transform_invalidated;
+		}
+
+		void widget_store_t::invalidate(u32 id)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_flags[id] |= transform_invalidated;
+		}
+
+		point2i widget_store_t::scroll_offset(u32 id) const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_scroll_offsets[id];
+		}
+
+		point2i widget_store_t::absolute_position(u32 id) const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_absolute_positions[id];
+		}
+
+		size2i widget_store_t::top_size(u32 id) const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_top_sizes[id];
+		}
+
+		matrix4f widget_store_t::matrix(u32 id) const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_matrices[id];
+		}
+
+		vector4f widget_store_t::clip(u32 id) const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return m_clips[id];
+		}
+
+		bool widget_store_t::visible(u32 id) const
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			return (m_flags[id] & is_visible) != 0;
+		}
+
+		void widget_store_t::update_transforms()
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+
+			if (m_order_invalidated)
+			{
+				rebuild_order();
+			}
+
+			for (u32 id : m_order)
+			{
+				u32 parent = m_parents[id];
+				byte flags_ = m_flags[id] & ~transform_updated;
+
+				//parents are swept first, a recomputed parent moves its whole subtree
+				if (parent != no_parent && (m_flags[parent] & transform_updated))
+				{
+					flags_ |= transform_invalidated;
+				}
+
+				if (!(flags_ & transform_invalidated))
+				{
+					m_flags[id] = flags_;
+					continue;
+				}
+
+				flags_ = (flags_ & ~(transform_invalidated | is_visible)) | transform_updated;
+
+				point2i position_ = m_positions[id];
+				size2i size_ = m_sizes[id];
+				point2i absolute_position_;
+				size2i parent_size;
+				size2i top_size_;
+
+				if (parent != no_parent)
+				{
+					//a scrolled parent shifts its childs, its own clip stays in place
+					position_ += m_scroll_offsets[parent];
+					absolute_position_ = m_absolute_positions[parent] + position_;
+					parent_size = m_sizes[parent];
+					top_size_ = m_top_sizes[parent];
+				}
+				else
+				{
+					parent_size = size_;
+					top_size_ = size_;
+				}
+
+				m_absolute_positions[id] = absolute_position_;
+				m_top_sizes[id] = top_size_;
+
+				bool visible_ = (flags_ & is_shown) != 0;
+
+				if (visible_ && parent != no_parent)
+				{
+					point2i down_position = position_ + size_;
+
+					visible_ = down_position.x() > 0 && down_position.y() > 0 &&
+						parent_size.width() != 0 && parent_size.height() != 0 &&
+						position_.x() < parent_size.width() && position_.y() < parent_size.height();
+				}
+
+				if (visible_)
+				{
+					flags_ |= is_visible;
+				}
+
+				m_flags[id] = flags_;
+
+				if (!visible_ || top_size_.width() <= 0 || top_size_.height() <= 0)
+				{
+					m_matrices[id] = { 0.f };
+					m_clips[id] = {};
+					continue;
+				}
+
+				//matrices and clips are computed in one batch once the sweep is done
+				//roots are placed at the origin and clipped by themselves
+				mtx::rect_source source;
+				source.position = parent != no_parent ? (point2f)position_ : point2f{};
+				source.parent_offset = parent != no_parent ? (point2f)m_absolute_positions[parent] : point2f{};
+				source.size = (size2f)size_;
+				source.parent_size = (size2f)parent_size;
+				source.global_size = (size2f)top_size_;
+
+				m_rect_sources.push_back(source);
+				m_rect_ids.push_back(id);
+			}
+
+			mtx::rect_transforms(m_rect_sources.data(), m_rect_sources.size(), m_matrices.data(), m_clips.data(), m_rect_ids.data());
+			m_rect_sources.clear();
+			m_rect_ids.clear();
+		}
+	}
+}
@@ -117,15 +117,7 @@ namespace rfe
 			{
 				thread = make_thread_queue([this]
 				{
-					if (m_handle)
-					{
-						MSG msg;
-						while (PeekMessageW(&msg, (HWND)m_handle, 0, 0, PM_REMOVE))
-						{
-							TranslateMessage(&msg);
-							DispatchMessage(&msg);
-						}
-					}
+					process_events();
 				});
 
 				events_thread() = thread;
@@ -275,6 +267,39 @@ namespace rfe
 			SetWindowLongPtr((HWND)m_handle, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
 		}
 
+		void window::process_events()
+		{
+			if (!m_handle)
+			{
+				return;
+			}
+
+			if (wait_events && !GetQueueStatus(QS_ALLINPUT))
+			{
+				MsgWaitForMultipleObjects(0, nullptr, FALSE, 16, QS_ALLINPUT);
+			}
+
+			//a mouse move followed by another with the same buttons only reports the latest pointer position
+			MSG msg;
+			MSG next;
+			u64 coalesced = 0;
+
+			while (PeekMessageW(&msg, (HWND)m_handle, 0, 0, PM_REMOVE))
+			{
+				if (msg.message == WM_MOUSEMOVE && PeekMessageW(&next, (HWND)m_handle, 0, 0, PM_NOREMOVE) &&
+					next.message == WM_MOUSEMOVE && next.wParam == msg.wParam)
+				{
+					++coalesced;
+					continue;
+				}
+
+				TranslateMessage(&msg);
+				DispatchMessage(&msg);
+			}
+
+			m_coalesced_events += coalesced;
+		}
+
 		void window::remove_dc()
 		{
 			m_draw_context = nullptr;
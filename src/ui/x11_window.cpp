@@ -1,7 +1,10 @@
-//TODO
 #ifndef _WIN32
 #include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <poll.h>
 #include <iostream>
+#include <vector>
+#include <mutex>
 #include <rfe/core/fmt.h>
 #include <rfe/core/events.h>
 #include <rfe/ui/window.h>
@@ -17,12 +20,113 @@ namespace rfe
 			Window window;
 		};
 
-		window::window()
+		//upper bound for a single wait, so invokes queued to the window thread are not starved
+		static constexpr int g_wait_events_timeout_ms = 16;
+
+		static int mouse_button_index(unsigned int button)
+		{
+			switch (button)
+			{
+			case Button1: return 0;
+			case Button2: return 1;
+			case Button3: return 2;
+			}
+
+			return -1;
+		}
+
+		static void dispatch_event(window *wnd, const XEvent &event)
+		{
+			switch (event.type)
+			{
+			case KeyPress:
+				events::keyboard::onkey_down(synchronized, (int)event.xkey.keycode);
+				break;
+
+			case KeyRelease:
+				events::keyboard::onkey_up(synchronized, (int)event.xkey.keycode);
+				break;
+
+			case ButtonPress:
+			{
+				int button = mouse_button_index(event.xbutton.button);
+
+				if (button < 0)
+				{
+					break;
+				}
+
+				point2i point{ event.xbutton.x, event.xbutton.y };
+
+				if (events::mouse::onkey_down(synchronized, button, point) == event_result::skip && button == 0)
+				{
+					wnd->ontouch(synchronized, point);
+				}
+			}
+			break;
+
+			case ButtonRelease:
+			{
+				int button = mouse_button_index(event.xbutton.button);
+
+				if (button < 0)
+				{
+					break;
+				}
+
+				point2i point{ event.xbutton.x, event.xbutton.y };
+
+				if (events::mouse::onkey_up(synchronized, button, point) == event_result::skip && button == 0)
+				{
+					if (wnd->motion_started())
+					{
+						wnd->onmotion_end(synchronized, point);
+					}
+					else
+					{
+						wnd->ontry_click(synchronized, point);
+					}
+				}
+			}
+			break;
+
+			case MotionNotify:
+				events::mouse::motion(synchronized, { event.xmotion.x, event.xmotion.y });
+				break;
+
+				//case DestroyNotify:
+				//	if (event.xany.display == handle->display && event.xany.window == handle->window)
+				//	{
+				//		onclose();
+				//	}
+				//	break;
+
+			case ConfigureNotify:
+				wnd->size.change(ignore_custom_invoker, { event.xconfigure.width, event.xconfigure.height });
+				wnd->position.change(ignore_custom_invoker, { event.xconfigure.x, event.xconfigure.y });
+				break;
+
+			case ClientMessage:
+				wnd->onclose(synchronized);
+				break;
+			}
+		}
+
+		window::window(bool make_thread)
 		{
+			if (make_thread)
+			{
+				thread = make_thread_queue([this]
+				{
+					process_events();
+				});
+
+				events_thread() = thread;
+			}
+
 			clear_color = { 0.4f, 0.4f, 0.4f, 1.0f };
 			clear_depth = 1.f;
 			clear_stencil = 0xff;
-			shown = false;
 
 			title.get_function([&]() -> std::string
 			{
@@ -30,8 +134,13 @@ namespace rfe
 					return{};
 
 				handle_t *handle = (handle_t*)m_handle;
-				char* result;
-				XFetchName(handle->display, handle->window, &result);
+				char* name = nullptr;
+
+				if (!XFetchName(handle->display, handle->window, &name) || !name)
+					return{};
+
+				std::string result = name;
+				XFree(name);
 				return result;
 			});
 
@@ -63,7 +172,7 @@ namespace rfe
 					return;
 
 				handle_t *handle = (handle_t*)m_handle;
-				XMoveWindow(handle->display, handle->window, value.x, value.y);
+				XMoveWindow(handle->display, handle->window, value.x(), value.y());
 			});
 
 			//			size.get_function([&]() -> size2i
@@ -88,7 +197,7 @@ namespace rfe
 					return;
 
 				handle_t *handle = (handle_t*)m_handle;
-				XResizeWindow(handle->display, handle->window, value.width, value.height);
+				XResizeWindow(handle->display, handle->window, value.width(), value.height());
 			});
 
 			//shown.get_function([&]() -> bool
@@ -116,18 +225,22 @@ namespace rfe
 //				XFlush(handle->display);
 //			});
 
-			create();
+			thread.invoke([=] { create(); });
 		}
 
+		//PointerMotionHintMask is not used: motion is coalesced in process_events instead
 		static constexpr u32 g_window_events_masks =
 			KeyPressMask | KeyReleaseMask |
 			PropertyChangeMask | ResizeRedirectMask |
 			ButtonPressMask | ButtonReleaseMask |
-			Button1MotionMask | PointerMotionMask | PointerMotionHintMask |
+			Button1MotionMask | PointerMotionMask |
 			FocusChangeMask | VisibilityChangeMask | StructureNotifyMask | SubstructureRedirectMask;
 
 		void window::create()
 		{
+			static std::once_flag init_threads;
+			std::call_once(init_threads, [] { XInitThreads(); });
+
 			handle_t *handle = new handle_t();
 			m_handle = handle;
 			if (!(handle->display = XOpenDisplay(nullptr)))
@@ -156,79 +269,66 @@ namespace rfe
 
 		void window::remove_dc()
 		{
-			std::lock_guard<std::mutex> lock(m_mtx);
 			m_draw_context = nullptr;
 		}
 
-		int IfEventCheck(Display*, XEvent*, XPointer)
+		void window::process_events()
 		{
-			return True;
-		}
+			handle_t *handle = (handle_t*)m_handle;
 
-		void window::update_events()
-		{
-			if (m_handle)
+			if (!handle)
 			{
-				handle_t *handle = (handle_t*)m_handle;
-				XEvent event;
+				return;
+			}
 
+			if (!XPending(handle->display))
+			{
+				if (!wait_events)
+				{
+					return;
+				}
 
-				if (XCheckIfEvent(handle->display, &event, IfEventCheck, nullptr))//(XCheckMaskEvent(handle->display, g_window_events_masks, &event))
+				pollfd connection{ ConnectionNumber(handle->display), POLLIN, 0 };
+
+				if (poll(&connection, 1, g_wait_events_timeout_ms) <= 0 || !XPending(handle->display))
 				{
-					switch (event.type)
+					return;
+				}
+			}
+
+			//drain everything the server has sent so far, then dispatch as one batch.
+			//consecutive motion events only report the latest pointer position
+			static thread_local std::vector<XEvent> batch;
+			u64 coalesced = 0;
+
+			while (XPending(handle->display))
+			{
+				XEvent event;
+				XNextEvent(handle->display, &event);
+
+				if (event.type == MotionNotify && !batch.empty())
+				{
+					XEvent &last = batch.back();
+
+					if (last.type == MotionNotify && last.xmotion.window == event.xmotion.window && last.xmotion.state == event.xmotion.state)
 					{
-					case KeyPress:
-						events::keyboard::onkey_down(event.xkey.keycode);
-						break;
-
-					case KeyRelease:
-						events::keyboard::onkey_up(event.xkey.keycode);
-						break;
-
-					case ButtonPress:
-						events::mouse::onkey_down({ event.xbutton.button, {event.xbutton.x, event.xbutton.y} });
-						break;
-
-					case MotionNotify:
-						events::mouse::motion({ event.xmotion.x, event.xmotion.y });
-						break;
-
-					case ButtonRelease:
-						if (event.xbutton.button == 1 && event.xany.window == handle->window && event.xany.display == handle->display)
-						{
-							onclick({ event.xbutton.x, event.xbutton.y });
-						}
-						else
-						{
-							events::mouse::onkey_up({ event.xbutton.button, {event.xbutton.x, event.xbutton.y} });
-						}
-						break;
-
-						//case DestroyNotify:
-						//	if (event.xany.display == handle->display && event.xany.window == handle->window)
-						//	{
-						//		onclose();
-						//	}
-						//	break;
-
-					case ConfigureNotify:
-						//if (size() != size2i{event.xconfigurerequest.width, event.xconfigurerequest.height})
-						size.change({ event.xconfigurerequest.width, event.xconfigurerequest.height }, false);
-						//if (position() != position2i{event.xconfigurerequest.x, event.xconfigurerequest.y})
-						position.change({ event.xconfigurerequest.x, event.xconfigurerequest.y }, false);
-						break;
-
-					case ClientMessage:
-						onclose();
-						break;
+						last = event;
+						++coalesced;
+						continue;
 					}
 				}
+
+				batch.push_back(event);
 			}
-		}
 
-		void *window::hwnd() const
-		{
-			return m_handle;
+			m_coalesced_events += coalesced;
+
+			for (const XEvent &event : batch)
+			{
+				dispatch_event(this, event);
+			}
+
+			batch.clear();
 		}
 
 		event_result window::doclose()
@@ -256,11 +356,10 @@ namespace rfe
 		{
 			if (handle_t *handle = (handle_t*)m_handle)
 			{
-				XSetInputFocus(handle->display, handle->window, 0, 0);
+				XSetInputFocus(handle->display, handle->window, RevertToParent, CurrentTime);
 				widget::focus();
 			}
 		}
 	}
 }
 #endif
-